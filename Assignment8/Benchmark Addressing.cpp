@@ -0,0 +1,117 @@
+#include <iostream>
+using std::cout;
+using std::endl;
+
+#include <chrono>
+#include <cstdlib>
+#include <vector>
+#include <deque>
+#include "Student ID - deque - erase.h"
+
+template< typename T >
+void benchAddressing( size_t mapSize );
+
+template< typename Func >
+double timeIt( Func func );
+
+int main()
+{
+   benchAddressing< char >( 1024 );
+   benchAddressing< short >( 1024 );
+   benchAddressing< long >( 1024 );
+   benchAddressing< long long >( 1024 );
+   system( "pause" );
+}
+
+// return the fastest of five runs of func, in milliseconds
+template< typename Func >
+double timeIt( Func func )
+{
+   double best = 0;
+   for( int run = 0; run < 5; run++ )
+   {
+      auto start = std::chrono::steady_clock::now();
+      func();
+      std::chrono::duration< double, std::milli > elapsed = std::chrono::steady_clock::now() - start;
+      if( run == 0 || elapsed.count() < best )
+         best = elapsed.count();
+   }
+   return best;
+}
+
+// time one dereference per element for every block-address formula;
+// the map is small enough to stay in cache, so the address math dominates
+template< typename T >
+void benchAddressing( size_t mapSize )
+{
+   using Val = DequeVal< T >;
+   const size_t dequeSize = Val::dequeSize; // elements per block (a power of 2)
+   const size_t passes = 200;
+
+   Val val;
+   val.mapSize = mapSize;
+   val.map = new T *[ mapSize ]();
+   for( size_t i = 0; i < mapSize; i++ )
+   {
+      val.map[ i ] = new T[ dequeSize ];
+      for( size_t j = 0; j < dequeSize; j++ )
+         val.map[ i ][ j ] = static_cast< T >( i + j );
+   }
+   val.myOff = dequeSize * mapSize / 2 + 1; // wrap around the end of the map
+   val.mySize = dequeSize * mapSize - 1;
+
+   // read through a volatile so the map size stays a run-time value,
+   // as it is inside the container
+   volatile size_t runtimeMapSize = mapSize;
+   volatile long long sink = 0;
+
+   double moduloTime = timeIt( [ & ]()
+   {
+      size_t n = runtimeMapSize;
+      long long sum = 0;
+      for( size_t pass = 0; pass < passes; pass++ )
+         for( size_t off = val.myOff; off < val.myOff + val.mySize; off++ )
+            sum += val.map[ off % ( dequeSize * n ) / dequeSize ][ off % dequeSize ];
+      sink = sum;
+   } );
+
+   double divideTime = timeIt( [ & ]()
+   {
+      size_t n = runtimeMapSize;
+      long long sum = 0;
+      for( size_t pass = 0; pass < passes; pass++ )
+         for( size_t off = val.myOff; off < val.myOff + val.mySize; off++ )
+            sum += val.map[ off / dequeSize % n ][ off % dequeSize ];
+      sink = sum;
+   } );
+
+   double maskTime = timeIt( [ & ]()
+   {
+      long long sum = 0;
+      for( size_t pass = 0; pass < passes; pass++ )
+         for( size_t off = val.myOff; off < val.myOff + val.mySize; off++ )
+            sum += val.map[ val.getBlock( off ) ][ off % dequeSize ];
+      sink = sum;
+   } );
+
+   double iteratorTime = timeIt( [ & ]()
+   {
+      long long sum = 0;
+      DequeConstIterator< Val > first( val.myOff, &val );
+      for( size_t pass = 0; pass < passes; pass++ )
+         for( size_t i = 0; i < val.mySize; i++ )
+            sum += first[ static_cast< ptrdiff_t >( i ) ];
+      sink = sum;
+   } );
+
+   double perDeref = 1e6 / ( static_cast< double >( passes ) * val.mySize ); // ms -> ns per element
+   cout << "sizeof( T ) = " << sizeof( T ) << ", mapSize = " << mapSize << endl;
+   cout << "   off % ( dequeSize * mapSize ) / dequeSize  " << moduloTime * perDeref << " ns\n";
+   cout << "   off / dequeSize % mapSize                  " << divideTime * perDeref << " ns\n";
+   cout << "   getBlock: ( off / dequeSize ) & mask       " << maskTime * perDeref << " ns\n";
+   cout << "   const_iterator[ i ]                        " << iteratorTime * perDeref << " ns\n\n";
+
+   for( size_t i = 0; i < mapSize; i++ )
+      delete[] val.map[ i ];
+   delete[] val.map;
+}
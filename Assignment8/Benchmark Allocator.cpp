@@ -0,0 +1,99 @@
+#include <iostream>
+using std::cout;
+using std::endl;
+
+#include <chrono>
+#include <memory_resource>
+#include <vector>
+#include "Student ID - deque - insert.h"
+
+template< typename T >
+void benchAllocator( size_t requests, size_t queueLength );
+
+template< typename Func >
+double timeIt( Func func );
+
+int main()
+{
+   benchAllocator< char >( 20000, 1000 );
+   benchAllocator< short >( 20000, 1000 );
+   benchAllocator< long >( 20000, 1000 );
+   benchAllocator< long long >( 20000, 1000 );
+   system( "pause" );
+}
+
+// return the fastest of five runs of func, in milliseconds
+template< typename Func >
+double timeIt( Func func )
+{
+   double best = 0;
+   for( int run = 0; run < 5; run++ )
+   {
+      auto start = std::chrono::steady_clock::now();
+      func();
+      std::chrono::duration< double, std::milli > elapsed = std::chrono::steady_clock::now() - start;
+      if( run == 0 || elapsed.count() < best )
+         best = elapsed.count();
+   }
+   return best;
+}
+
+// serve requests short-lived work queues, each filled with queueLength elements
+// from both ends, drained by half and then destroyed with its request
+template< typename T, typename Deque, typename MakeDeque >
+long long serveRequests( size_t requests, size_t queueLength, MakeDeque makeDeque )
+{
+   long long sum = 0;
+   for( size_t r = 0; r < requests; r++ )
+   {
+      Deque deque1 = makeDeque();
+      for( size_t i = 0; i < queueLength; i++ )
+         if( i % 2 == 0 )
+            deque1.push_back( static_cast< T >( i ) );
+         else
+            deque1.push_front( static_cast< T >( i ) );
+      for( size_t i = 0; i < queueLength / 2; i++ )
+      {
+         sum += deque1.front();
+         deque1.pop_front();
+      }
+      sum += deque1.back();
+   }
+   return sum;
+}
+
+// compare the global heap against a monotonic arena that is released wholesale
+// at the end of each request, as a per-request arena would be
+template< typename T >
+void benchAllocator( size_t requests, size_t queueLength )
+{
+   using HeapDeque = deque< T >;
+   using ArenaDeque = deque< T, DequeDefaultBlock, std::pmr::polymorphic_allocator< T > >;
+
+   volatile long long sink = 0;
+
+   double heapTime = timeIt( [ & ]()
+   {
+      sink = serveRequests< T, HeapDeque >( requests, queueLength,
+         []() { return HeapDeque(); } );
+   } );
+
+   std::vector< char > buffer( 64 * 1024 );
+   double arenaTime = timeIt( [ & ]()
+   {
+      long long sum = 0;
+      for( size_t r = 0; r < requests; r++ )
+      {
+         std::pmr::monotonic_buffer_resource arena( buffer.data(), buffer.size() );
+         sum += serveRequests< T, ArenaDeque >( 1, queueLength,
+            [ & ]() { return ArenaDeque( &arena ); } );
+      }
+      sink = sum;
+   } );
+
+   double perRequest = 1e6 / static_cast< double >( requests ); // ms -> ns per request
+   cout << "sizeof( T ) = " << sizeof( T ) << ", " << requests << " requests of "
+        << queueLength << " elements" << endl;
+   cout << "   global heap                   " << heapTime * perRequest << " ns\n";
+   cout << "   monotonic arena               " << arenaTime * perRequest << " ns\n\n";
+}
@@ -0,0 +1,113 @@
+#include <iostream>
+using std::cout;
+using std::endl;
+
+#include <chrono>
+#include <memory_resource>
+#include <vector>
+#include "Student ID - deque - insert.h"
+#include "Huge Page Resource.h"
+
+template< typename T, typename Deque >
+void benchStorage( const char *name, Deque &deque1, size_t count, const std::vector< size_t > &indices );
+
+template< typename T >
+void benchHugePages( size_t count );
+
+template< typename Func >
+double timeIt( Func func );
+
+int main()
+{
+   benchHugePages< long long >( 64000000 );
+   benchHugePages< long >( 64000000 );
+   system( "pause" );
+}
+
+// return the fastest of five runs of func, in milliseconds
+template< typename Func >
+double timeIt( Func func )
+{
+   double best = 0;
+   for( int run = 0; run < 5; run++ )
+   {
+      auto start = std::chrono::steady_clock::now();
+      func();
+      std::chrono::duration< double, std::milli > elapsed = std::chrono::steady_clock::now() - start;
+      if( run == 0 || elapsed.count() < best )
+         best = elapsed.count();
+   }
+   return best;
+}
+
+// fill deque1 with count elements, then time a sequential scan and
+// random reads at the given indices
+template< typename T, typename Deque >
+void benchStorage( const char *name, Deque &deque1, size_t count, const std::vector< size_t > &indices )
+{
+   volatile long long sink = 0;
+
+   auto start = std::chrono::steady_clock::now();
+   for( size_t i = 0; i < count; i++ )
+      deque1.push_back( static_cast< T >( i ) );
+   std::chrono::duration< double, std::milli > fillTime = std::chrono::steady_clock::now() - start;
+
+   double scanTime = timeIt( [ & ]()
+   {
+      long long sum = 0;
+      for( typename Deque::iterator it = deque1.begin(); it != deque1.end(); ++it )
+         sum += *it;
+      sink = sum;
+   } );
+
+   double randomTime = timeIt( [ & ]()
+   {
+      long long sum = 0;
+      typename Deque::iterator first = deque1.begin();
+      for( size_t i = 0; i < indices.size(); i++ )
+         sum += first[ static_cast< ptrdiff_t >( indices[ i ] ) ];
+      sink = sum;
+   } );
+
+   double perElement = 1e6 / static_cast< double >( count ); // ms -> ns per element
+   double perRead = 1e6 / static_cast< double >( indices.size() );
+   cout << "   " << name << "fill " << fillTime.count() * perElement << " ns, scan "
+        << scanTime * perElement << " ns, random " << randomTime * perRead << " ns\n";
+}
+
+// compare blocks from the global heap against blocks carved from huge-page
+// regions, with the default block size and with 4 KiB blocks
+template< typename T >
+void benchHugePages( size_t count )
+{
+   using PageAlloc = std::pmr::polymorphic_allocator< T >;
+
+   std::vector< size_t > indices( 4000000 );
+   size_t seed = 12345;
+   for( size_t i = 0; i < indices.size(); i++ )
+   {
+      seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+      indices[ i ] = ( seed >> 16 ) % count;
+   }
+
+   cout << "sizeof( T ) = " << sizeof( T ) << ", " << count << " elements" << endl;
+   {
+      deque< T > deque1;
+      benchStorage< T >( "heap,       default blocks  ", deque1, count, indices );
+   }
+   {
+      HugePageResource resource;
+      deque< T, DequeDefaultBlock, PageAlloc > deque1( &resource );
+      benchStorage< T >( "huge pages, default blocks  ", deque1, count, indices );
+   }
+   {
+      deque< T, DequeBlockBytes< 4096 > > deque1;
+      benchStorage< T >( "heap,       4 KiB blocks    ", deque1, count, indices );
+   }
+   {
+      HugePageResource resource;
+      deque< T, DequeBlockBytes< 4096 >, PageAlloc > deque1( &resource );
+      benchStorage< T >( "huge pages, 4 KiB blocks    ", deque1, count, indices );
+   }
+   cout << endl;
+}
@@ -0,0 +1,71 @@
+#include <iostream>
+using std::cout;
+using std::endl;
+
+#include <chrono>
+#include <thread>
+#include "Student ID - deque - fill constructor.h"
+
+template< typename T >
+void benchParallelFill( size_t count );
+
+template< typename Func >
+double timeIt( Func func );
+
+int main()
+{
+   benchParallelFill< long long >( 64000000 );
+   benchParallelFill< long >( 64000000 );
+   system( "pause" );
+}
+
+// return the fastest of five runs of func, in milliseconds
+template< typename Func >
+double timeIt( Func func )
+{
+   double best = 0;
+   for( int run = 0; run < 5; run++ )
+   {
+      auto start = std::chrono::steady_clock::now();
+      func();
+      std::chrono::duration< double, std::milli > elapsed = std::chrono::steady_clock::now() - start;
+      if( run == 0 || elapsed.count() < best )
+         best = elapsed.count();
+   }
+   return best;
+}
+
+// time the fill constructor on count elements with 1, 2, 4, ... workers,
+// up to the number of hardware threads
+template< typename T >
+void benchParallelFill( size_t count )
+{
+   volatile long long sink = 0;
+
+   unsigned maxThreads = std::thread::hardware_concurrency();
+   if( maxThreads == 0 )
+      maxThreads = 1;
+
+   cout << "sizeof( T ) = " << sizeof( T ) << ", " << count << " elements" << endl;
+   DequeParallel::threshold = 1;
+   double single = 0;
+   for( unsigned threads = 1; ; threads = threads * 2 < maxThreads ? threads * 2 : maxThreads )
+   {
+      DequeParallel::threads = threads;
+      double fillTime = timeIt( [ & ]()
+      {
+         deque< T > deque1( count, static_cast< T >( 7 ) );
+         sink = *deque1.begin();
+      } );
+      if( threads == 1 )
+         single = fillTime;
+
+      double bytes = static_cast< double >( count ) * sizeof( T );
+      cout << "   " << threads << ( threads == 1 ? " thread      " : " threads     " ) << fillTime << " ms, "
+           << bytes / fillTime / 1e6 << " GB/s, speedup " << single / fillTime << endl;
+      if( threads == maxThreads )
+         break;
+   }
+   DequeParallel::threads = 1;
+   cout << endl;
+}
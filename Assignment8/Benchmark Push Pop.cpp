@@ -0,0 +1,126 @@
+#include <iostream>
+using std::cout;
+using std::endl;
+
+#include <chrono>
+#include <deque>
+#include "Student ID - deque - insert.h"
+
+template< typename T >
+void benchPushPop( size_t count, size_t queueLength );
+
+template< typename Func >
+double timeIt( Func func );
+
+int main()
+{
+   benchPushPop< char >( 16000000, 1000 );
+   benchPushPop< short >( 16000000, 1000 );
+   benchPushPop< long >( 16000000, 1000 );
+   benchPushPop< long long >( 16000000, 1000 );
+   system( "pause" );
+}
+
+// return the fastest of five runs of func, in milliseconds
+template< typename Func >
+double timeIt( Func func )
+{
+   double best = 0;
+   for( int run = 0; run < 5; run++ )
+   {
+      auto start = std::chrono::steady_clock::now();
+      func();
+      std::chrono::duration< double, std::milli > elapsed = std::chrono::steady_clock::now() - start;
+      if( run == 0 || elapsed.count() < best )
+         best = elapsed.count();
+   }
+   return best;
+}
+
+// fill a deque with count elements from either end, then run count operations
+// of a FIFO work queue holding about queueLength elements
+template< typename T >
+void benchPushPop( size_t count, size_t queueLength )
+{
+   volatile long long sink = 0;
+
+   double stdBackTime = timeIt( [ & ]()
+   {
+      std::deque< T > deque1;
+      for( size_t i = 0; i < count; i++ )
+         deque1.push_back( static_cast< T >( i ) );
+      sink = deque1.back();
+   } );
+
+   double insertBackTime = timeIt( [ & ]()
+   {
+      deque< T > deque2;
+      for( size_t i = 0; i < count; i++ )
+         deque2.insert( deque2.end(), static_cast< T >( i ) );
+      sink = deque2.back();
+   } );
+
+   double backTime = timeIt( [ & ]()
+   {
+      deque< T > deque2;
+      for( size_t i = 0; i < count; i++ )
+         deque2.push_back( static_cast< T >( i ) );
+      sink = deque2.back();
+   } );
+
+   double stdFrontTime = timeIt( [ & ]()
+   {
+      std::deque< T > deque1;
+      for( size_t i = 0; i < count; i++ )
+         deque1.push_front( static_cast< T >( i ) );
+      sink = deque1.front();
+   } );
+
+   double frontTime = timeIt( [ & ]()
+   {
+      deque< T > deque2;
+      for( size_t i = 0; i < count; i++ )
+         deque2.emplace_front( static_cast< T >( i ) );
+      sink = deque2.front();
+   } );
+
+   double stdQueueTime = timeIt( [ & ]()
+   {
+      std::deque< T > deque1;
+      long long sum = 0;
+      for( size_t i = 0; i < queueLength; i++ )
+         deque1.push_back( static_cast< T >( i ) );
+      for( size_t i = 0; i < count; i++ )
+      {
+         sum += deque1.front();
+         deque1.pop_front();
+         deque1.push_back( static_cast< T >( i ) );
+      }
+      sink = sum;
+   } );
+
+   double queueTime = timeIt( [ & ]()
+   {
+      deque< T > deque2;
+      long long sum = 0;
+      for( size_t i = 0; i < queueLength; i++ )
+         deque2.push_back( static_cast< T >( i ) );
+      for( size_t i = 0; i < count; i++ )
+      {
+         sum += deque2.front();
+         deque2.pop_front();
+         deque2.push_back( static_cast< T >( i ) );
+      }
+      sink = sum;
+   } );
+
+   double perOp = 1e6 / static_cast< double >( count ); // ms -> ns per operation
+   cout << "sizeof( T ) = " << sizeof( T ) << ", " << count << " operations" << endl;
+   cout << "   std::deque push_back          " << stdBackTime * perOp << " ns\n";
+   cout << "   insert( end(), val )          " << insertBackTime * perOp << " ns\n";
+   cout << "   push_back                     " << backTime * perOp << " ns\n";
+   cout << "   std::deque push_front         " << stdFrontTime * perOp << " ns\n";
+   cout << "   emplace_front                 " << frontTime * perOp << " ns\n";
+   cout << "   std::deque FIFO of " << queueLength << "         " << stdQueueTime * perOp << " ns\n";
+   cout << "   FIFO of " << queueLength << "                    " << queueTime * perOp << " ns\n\n";
+}
@@ -0,0 +1,98 @@
+#include <iostream>
+using std::cout;
+using std::endl;
+
+#include <chrono>
+#include <deque>
+#include <vector>
+#include "Student ID - deque - fill constructor.h"
+
+template< typename T >
+void benchSegments( size_t count );
+
+template< typename Func >
+double timeIt( Func func );
+
+int main()
+{
+   benchSegments< char >( 64000000 );
+   benchSegments< short >( 32000000 );
+   benchSegments< long >( 16000000 );
+   benchSegments< long long >( 16000000 );
+   system( "pause" );
+}
+
+// return the fastest of five runs of func, in milliseconds
+template< typename Func >
+double timeIt( Func func )
+{
+   double best = 0;
+   for( int run = 0; run < 5; run++ )
+   {
+      auto start = std::chrono::steady_clock::now();
+      func();
+      std::chrono::duration< double, std::milli > elapsed = std::chrono::steady_clock::now() - start;
+      if( run == 0 || elapsed.count() < best )
+         best = elapsed.count();
+   }
+   return best;
+}
+
+// sum every element of a deque of count elements, once per traversal style
+template< typename T >
+void benchSegments( size_t count )
+{
+   T value = static_cast< T >( 3 );
+   std::vector< T > vector1( count, value );
+   std::deque< T > deque1( count, value );
+   deque< T > deque2( count, value );
+
+   volatile long long sink = 0;
+
+   double arrayTime = timeIt( [ & ]()
+   {
+      long long sum = 0;
+      const T *p = vector1.data();
+      for( size_t i = 0; i < count; i++ )
+         sum += p[ i ];
+      sink = sum;
+   } );
+
+   double stdTime = timeIt( [ & ]()
+   {
+      long long sum = 0;
+      for( typename std::deque< T >::const_iterator it = deque1.begin(); it != deque1.end(); ++it )
+         sum += *it;
+      sink = sum;
+   } );
+
+   double iteratorTime = timeIt( [ & ]()
+   {
+      long long sum = 0;
+      const deque< T > &cDeque = deque2;
+      for( typename deque< T >::const_iterator it = cDeque.begin(); it != cDeque.end(); ++it )
+         sum += *it;
+      sink = sum;
+   } );
+
+   long long segmentSum = 0;
+   double segmentTime = timeIt( [ & ]()
+   {
+      long long sum = 0;
+      const deque< T > &cDeque = deque2;
+      cDeque.for_each_segment( [ &sum ]( const T *p, size_t n )
+      {
+         for( size_t i = 0; i < n; i++ )
+            sum += p[ i ];
+      } );
+      segmentSum = sum;
+      sink = sum;
+   } );
+
+   cout << "sizeof( T ) = " << sizeof( T ) << ", " << count << " elements"
+        << ( segmentSum == static_cast< long long >( count ) * value ? "" : "  (sum mismatch!)" ) << endl;
+   cout << "   plain array      " << arrayTime << " ms\n";
+   cout << "   std::deque       " << stdTime << " ms\n";
+   cout << "   iterator loop    " << iteratorTime << " ms\n";
+   cout << "   for_each_segment " << segmentTime << " ms\n\n";
+}
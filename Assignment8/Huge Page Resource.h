@@ -0,0 +1,194 @@
+#ifndef HUGE_PAGE_RESOURCE_H
+#define HUGE_PAGE_RESOURCE_H
+
+#include <cstddef>
+#include <memory_resource>
+#include <new>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+// CLASS HugePageResource
+// memory resource that carves deque blocks and maps out of large regions
+// mapped straight from the OS, asking for transparent huge pages where the
+// platform offers them (MADV_HUGEPAGE); pass it to a deque through
+// std::pmr::polymorphic_allocator. Freed chunks go on a free list per size
+// class and are handed out again; the regions go back to the OS in bulk,
+// on release() or destruction. Not thread safe, like the std::pmr buffer resources
+class HugePageResource : public std::pmr::memory_resource
+{
+public:
+   static constexpr size_t hugePageSize = 2 * 1024 * 1024;
+
+   // regions are regionBytes long, rounded up to whole huge pages
+   explicit HugePageResource( size_t regionBytes = 32 * hugePageSize )
+      : regionSize( roundUp( regionBytes > 0 ? regionBytes : 1, hugePageSize ) ),
+        regions(),
+        next( nullptr ),
+        left( 0 ),
+        freeLists()
+   {
+   }
+
+   HugePageResource( const HugePageResource & ) = delete;
+   HugePageResource &operator=( const HugePageResource & ) = delete;
+
+   ~HugePageResource() override
+   {
+      release();
+   }
+
+   // return every region to the OS at once; all memory handed out becomes invalid
+   void release()
+   {
+      for( Region &region : regions )
+         unmapRegion( region.base, region.bytes );
+      regions.clear();
+      next = nullptr;
+      left = 0;
+      for( FreeChunk *&head : freeLists )
+         head = nullptr;
+   }
+
+   // return the number of bytes currently mapped from the OS
+   size_t mapped_bytes() const
+   {
+      size_t bytes = 0;
+      for( const Region &region : regions )
+         bytes += region.bytes;
+      return bytes;
+   }
+
+private:
+   struct Region
+   {
+      char *base;
+      size_t bytes;
+   };
+
+   struct FreeChunk
+   {
+      FreeChunk *next;
+   };
+
+   static constexpr size_t minChunk = 16; // size classes are minChunk << 0, 1, 2, ...
+   static constexpr size_t numClasses = 8 * sizeof( size_t ) - 4;
+
+   void *do_allocate( size_t bytes, size_t alignment ) override
+   {
+      size_t sizeClass = classOf( bytes > alignment ? bytes : alignment );
+      size_t chunk = minChunk << sizeClass;
+      if( chunk > regionSize / 4 ) // too large to carve: a region of its own
+         return mapRegion( roundUp( chunk, hugePageSize ) );
+
+      if( freeLists[ sizeClass ] != nullptr )
+      {
+         FreeChunk *head = freeLists[ sizeClass ];
+         freeLists[ sizeClass ] = head->next;
+         return head;
+      }
+
+      // chunks are carved at multiples of their own size, so they are aligned
+      size_t skip = roundUp( reinterpret_cast< size_t >( next ), chunk ) - reinterpret_cast< size_t >( next );
+      if( left < skip + chunk ) // the tail of the old region is abandoned
+      {
+         next = mapRegion( regionSize );
+         left = regionSize;
+         skip = 0;
+      }
+
+      char *p = next + skip;
+      next = p + chunk;
+      left -= skip + chunk;
+      return p;
+   }
+
+   void do_deallocate( void *p, size_t bytes, size_t alignment ) override
+   {
+      size_t sizeClass = classOf( bytes > alignment ? bytes : alignment );
+      if( ( minChunk << sizeClass ) > regionSize / 4 )
+      {
+         for( size_t i = 0; i < regions.size(); i++ )
+            if( regions[ i ].base == p )
+            {
+               unmapRegion( regions[ i ].base, regions[ i ].bytes );
+               regions.erase( regions.begin() + static_cast< ptrdiff_t >( i ) );
+               return;
+            }
+      }
+      else
+      {
+         FreeChunk *chunk = static_cast< FreeChunk * >( p );
+         chunk->next = freeLists[ sizeClass ];
+         freeLists[ sizeClass ] = chunk;
+      }
+   }
+
+   bool do_is_equal( const std::pmr::memory_resource &other ) const noexcept override
+   {
+      return this == &other;
+   }
+
+   // return the smallest size class whose chunks hold bytes
+   static size_t classOf( size_t bytes )
+   {
+      size_t sizeClass = 0;
+      while( ( minChunk << sizeClass ) < bytes )
+         sizeClass++;
+      return sizeClass;
+   }
+
+   static size_t roundUp( size_t n, size_t multiple ) // multiple is a power of 2
+   {
+      return ( n + multiple - 1 ) & ~( multiple - 1 );
+   }
+
+   // map bytes (a multiple of hugePageSize) from the OS, aligned to a huge page
+   char *mapRegion( size_t bytes )
+   {
+      regions.reserve( regions.size() + 1 ); // so recording the region cannot throw
+#ifdef _WIN32
+      // large pages need SeLockMemoryPrivilege; plain committed pages otherwise
+      char *base = static_cast< char * >( VirtualAlloc( nullptr, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE ) );
+      if( base == nullptr )
+         throw std::bad_alloc();
+#else
+      // over-map by one huge page, then trim both ends to a huge page boundary
+      void *raw = mmap( nullptr, bytes + hugePageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+      if( raw == MAP_FAILED )
+         throw std::bad_alloc();
+      char *start = static_cast< char * >( raw );
+      char *base = reinterpret_cast< char * >( roundUp( reinterpret_cast< size_t >( start ), hugePageSize ) );
+      if( base > start )
+         munmap( start, static_cast< size_t >( base - start ) );
+      munmap( base + bytes, static_cast< size_t >( start + hugePageSize - base ) );
+#ifdef MADV_HUGEPAGE
+      madvise( base, bytes, MADV_HUGEPAGE );
+#endif
+#endif
+      regions.push_back( Region{ base, bytes } );
+      return base;
+   }
+
+   static void unmapRegion( char *base, size_t bytes )
+   {
+#ifdef _WIN32
+      static_cast< void >( bytes );
+      VirtualFree( base, 0, MEM_RELEASE );
+#else
+      munmap( base, bytes );
+#endif
+   }
+
+   size_t regionSize;             // bytes in each region carved into chunks
+   std::vector< Region > regions; // every mapping, carved or not
+   char *next;                    // next free byte of the region being carved
+   size_t left;                   // bytes left in the region being carved
+   FreeChunk *freeLists[ numClasses ]; // returned chunks, by size class
+};
+
+#endif
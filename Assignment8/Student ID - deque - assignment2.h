@@ -1,6 +1,58 @@
 #ifndef DEQUE_H
 #define DEQUE_H
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// CLASS TEMPLATE DequeBlockBytes
+// block geometry policy: each block spans Bytes bytes, rounded down to
+// a power of 2 elements (at least one element per block)
+template< size_t Bytes >
+struct DequeBlockBytes
+{
+   template< typename Ty >
+   static constexpr size_t elements()
+   {
+      return floorPow2( Bytes / sizeof( Ty ) );
+   }
+
+private:
+   static constexpr size_t floorPow2( size_t n )
+   {
+      return n <= 1 ? 1 : 2 * floorPow2( n / 2 );
+   }
+};
+
+// CLASS TEMPLATE DequeBlockElements
+// block geometry policy: each block holds Count elements
+template< size_t Count >
+struct DequeBlockElements
+{
+   static_assert( Count > 0 && ( Count & ( Count - 1 ) ) == 0,
+                  "elements per block must be a power of 2" );
+
+   template< typename Ty >
+   static constexpr size_t elements()
+   {
+      return Count;
+   }
+};
+
+// 16 bytes per block: 16, 8, 4, 2 or 1 elements for 1, 2, 4, 8 or >8 byte types
+using DequeDefaultBlock = DequeBlockBytes< 16 >;
+
 // CLASS TEMPLATE DequeConstIterator
 template< typename MyDeque >
 class DequeConstIterator // iterator for nonmutable deque
@@ -9,6 +61,7 @@ private:
    using size_type = typename MyDeque::size_type;
 
 public:
+   using iterator_category = std::random_access_iterator_tag;
    using value_type = typename MyDeque::value_type;
    using difference_type = typename MyDeque::difference_type;
    using pointer = typename MyDeque::const_pointer;
@@ -16,21 +69,28 @@ public:
 
    // construct with null pointer
    DequeConstIterator()
-      : myOff( 0 ),
-      myCont( nullptr )
+      : myCont( nullptr ),
+        myOff( 0 ),
+        myCur( nullptr ),
+        myFirst( nullptr ),
+        myLast( nullptr )
    {
    }
 
    // construct with offset off in *pDeque
    DequeConstIterator( size_type off, const MyDeque *pDeque )
-      : myOff( off ),
-      myCont( pDeque )
+      : myCont( pDeque ),
+        myOff( off )
    {
+      setBlock();
    }
 
    DequeConstIterator( const DequeConstIterator &right ) // copy constructor
-      : myOff( right.myOff ),
-      myCont( right.myCont )
+      : myCont( right.myCont ),
+        myOff( right.myOff ),
+        myCur( right.myCur ),
+        myFirst( right.myFirst ),
+        myLast( right.myLast )
    {
    }
 
@@ -45,32 +105,28 @@ public:
       {
          myCont = right.myCont;
          myOff = right.myOff;
+         myCur = right.myCur;
+         myFirst = right.myFirst;
+         myLast = right.myLast;
       }
       return *this; // enables x = y = z, for example
    }
 
    reference operator*() const
    {
-      // elements per block (a power of 2)
-      size_type dequeSize = sizeof( value_type ) <= 1 ? 16 :
-                            sizeof( value_type ) <= 2 ?  8 :
-                            sizeof( value_type ) <= 4 ?  4 :
-                            sizeof( value_type ) <= 8 ?  2 : 1;
-
-//      size_type block = myOff % ( dequeSize * myCont->mapSize ) / dequeSize;
-      size_type block = myCont->getBlock( myOff );
-      size_type off = myOff % dequeSize;
-      return myCont->map[ block ][ off ];
+      return *myCur;
    }
 
    pointer operator->() const
    {
-      return &( operator*() );
+      return myCur;
    }
 
    DequeConstIterator& operator++() // preincrement
    {
       ++myOff;
+      if( ++myCur == myLast ) // stepped off the end of the block
+         setBlock();
       return *this;
    }
 
@@ -84,6 +140,10 @@ public:
    DequeConstIterator& operator--() // predecrement
    {
       --myOff;
+      if( myCur == myFirst ) // step back into the previous block
+         setBlock();
+      else
+         --myCur;
       return *this;
    }
 
@@ -98,6 +158,11 @@ public:
    DequeConstIterator& operator+=( const difference_type off )
    {
       myOff += off;
+      difference_type col = ( myCur - myFirst ) + off;
+      if( myFirst != nullptr && col >= 0 && col < static_cast< difference_type >( MyDeque::dequeSize ) )
+         myCur += off; // still inside the cached block
+      else
+         setBlock();
       return *this;
    }
 
@@ -170,6 +235,26 @@ public:
 
    const MyDeque *myCont; // keep a pointer to deque
    size_type myOff;       // offset of element in deque
+
+private:
+   // cache the bounds of the block holding myOff, so that dereferencing and
+   // stepping inside a block never touch the map
+   void setBlock()
+   {
+      if( myCont != nullptr && myCont->map != nullptr &&
+          myCont->map[ myCont->getBlock( myOff ) ] != nullptr )
+      {
+         myFirst = myCont->map[ myCont->getBlock( myOff ) ];
+         myLast = myFirst + MyDeque::dequeSize;
+         myCur = myFirst + myOff % MyDeque::dequeSize;
+      }
+      else // no block allocated there yet, e.g. end() on a block boundary
+         myCur = myFirst = myLast = nullptr;
+   }
+
+   pointer myCur;   // current element
+   pointer myFirst; // beginning of the block holding the current element
+   pointer myLast;  // end of the block holding the current element
 };
 
 
@@ -269,8 +354,188 @@ public:
    }
 };
 
+// memory held by a deque, as reported by deque::memory_stats()
+struct DequeMemoryStats
+{
+   size_t mapBytes;     // bytes in the map
+   size_t blockBytes;   // bytes in allocated blocks, spare blocks included
+   size_t totalBytes;   // mapBytes + blockBytes
+   size_t mapSlots;     // slots in the map
+   size_t nullSlots;    // map slots without a block
+   size_t blocks;       // blocks in the map
+   size_t liveBlocks;   // blocks holding at least one element
+   size_t spareBlocks;  // blocks on the spare list
+   size_t frontSlack;   // raw slots in the first live block, before the first element
+   size_t backSlack;    // raw slots in the last live block, after the last element
+   double occupancy;    // elements per slot in allocated blocks; 0 without blocks
+   size_t growthEvents; // times the map was allocated or grown
+};
+
+// opt-in parallel copy and fill of trivially copyable elements: an operation
+// on at least threshold elements hands each of threads workers its own run of
+// blocks. threads == 1, the default, keeps every operation on the calling thread.
+// The workers live in one pool shared by every deque, started on first use and
+// grown as threads rises; either setting may change while deques are in use
+struct DequeParallel
+{
+   static inline std::atomic< unsigned > threads{ 1 };             // workers, the calling thread included
+   static inline std::atomic< size_t > threshold{ size_t( 1 ) << 24 }; // fewest elements worth splitting
+
+   // return whether an operation on count elements is split across workers
+   static bool splits( size_t count )
+   {
+      return count > 0 && threads.load( std::memory_order_relaxed ) > 1 &&
+             count >= threshold.load( std::memory_order_relaxed );
+   }
+
+   // call work( first, last ) on one range per worker, the ranges covering
+   // [ 0, count ) with every inner boundary a multiple of grain; the calling
+   // thread takes the first range and then waits for the others
+   template< typename Work >
+   static void run( size_t count, size_t grain, Work work )
+   {
+      if( count == 0 )
+         return;
+
+      size_t units = ( count + grain - 1 ) / grain;
+      size_t wanted = threads.load( std::memory_order_relaxed );
+      size_t workers = wanted < units ? wanted : units;
+      Batch batch;
+      try
+      {
+         for( size_t w = 1; w < workers; w++ )
+         {
+            size_t first = units * w / workers * grain;
+            size_t last = units * ( w + 1 ) / workers * grain;
+            if( last > count )
+               last = count;
+            pool().submit( batch, workers - 1, [ &work, first, last ]() { work( first, last ); } );
+         }
+         size_t last = units / workers * grain;
+         work( size_t( 0 ), last < count ? last : count );
+      }
+      catch( ... )
+      {  // the ranges already handed out refer to work: let them finish first
+         batch.wait();
+         throw;
+      }
+      batch.wait();
+      if( batch.error )
+         std::rethrow_exception( batch.error );
+   }
+
+private:
+   // the ranges of one call to run still in the pool, and the first
+   // exception any of them raised
+   struct Batch
+   {
+      std::mutex mutex;
+      std::condition_variable done;
+      size_t pending = 0;
+      std::exception_ptr error;
+
+      // record that one range finished, raising error if it is not null
+      void finish( std::exception_ptr rangeError )
+      {
+         std::lock_guard< std::mutex > lock( mutex );
+         if( rangeError && !error )
+            error = rangeError;
+         if( --pending == 0 )
+            done.notify_all();
+      }
+
+      // block until every range handed out has finished
+      void wait()
+      {
+         std::unique_lock< std::mutex > lock( mutex );
+         done.wait( lock, [ this ]() { return pending == 0; } );
+      }
+   };
+
+   // worker threads serving ranges from a shared list, joined at exit
+   class Pool
+   {
+   public:
+      ~Pool()
+      {
+         {
+            std::lock_guard< std::mutex > lock( mutex );
+            stopping = true;
+         }
+         ready.notify_all();
+         for( std::thread &worker : workers )
+            worker.join();
+      }
+
+      // queue task as a range of batch, first starting workers until there
+      // are at least wanted; a throw leaves batch without the task
+      void submit( Batch &batch, size_t wanted, std::function< void() > task )
+      {
+         {
+            std::lock_guard< std::mutex > lock( mutex );
+            while( workers.size() < wanted )
+               workers.emplace_back( [ this ]() { serve(); } );
+            tasks.push_back( Task{ &batch, std::move( task ) } );
+
+            // counted before any worker can take the task
+            std::lock_guard< std::mutex > batchLock( batch.mutex );
+            ++batch.pending;
+         }
+         ready.notify_one();
+      }
+
+   private:
+      struct Task
+      {
+         Batch *batch;
+         std::function< void() > work;
+      };
+
+      // run queued tasks until the pool is destroyed
+      void serve()
+      {
+         for( ;; )
+         {
+            Task task;
+            {
+               std::unique_lock< std::mutex > lock( mutex );
+               ready.wait( lock, [ this ]() { return stopping || !tasks.empty(); } );
+               if( tasks.empty() )
+                  return;
+               task = std::move( tasks.back() );
+               tasks.pop_back();
+            }
+
+            std::exception_ptr error;
+            try
+            {
+               task.work();
+            }
+            catch( ... )
+            {
+               error = std::current_exception();
+            }
+            task.batch->finish( error );
+         }
+      }
+
+      std::mutex mutex;
+      std::condition_variable ready;
+      std::vector< std::thread > workers;
+      std::vector< Task > tasks; // taken from the back; their order does not matter
+      bool stopping = false;
+   };
+
+   // the pool every deque shares
+   static Pool &pool()
+   {
+      static Pool instance;
+      return instance;
+   }
+};
+
 // CLASS TEMPLATE DequeVal
-template< typename Ty >
+template< typename Ty, typename BlockPolicy = DequeDefaultBlock >
 class DequeVal // base class for deque to hold data
 {
 public:
@@ -283,42 +548,53 @@ public:
    using const_reference = const value_type &;
    using MapPtr = Ty **;
 
+   // elements per block (a power of 2)
+   static constexpr size_type dequeSize = BlockPolicy::template elements< Ty >();
+
+   // most blocks kept on the spare list; freed blocks beyond it go back to the heap
+   static constexpr size_type maxSpare = 8;
+
    DequeVal() // initialize values
       : map(),
       mapSize( 0 ),
       myOff( 0 ),
-      mySize( 0 )
+      mySize( 0 ),
+      spare(),
+      numSpare( 0 ),
+      numGrowths( 0 )
    {
    }
 
    // determine block from offset
    size_type getBlock( size_type off ) const
    {
-      // elements per block (a power of 2)
-      size_type dequeSize = sizeof( value_type ) <= 1 ? 16 :
-                            sizeof( value_type ) <= 2 ?  8 :
-                            sizeof( value_type ) <= 4 ?  4 :
-                            sizeof( value_type ) <= 8 ?  2 : 1;
-
-      return off / dequeSize % mapSize;
+      return ( off / dequeSize ) & ( mapSize - 1 ); // mapSize is zero or 2^N
+//      return off / dequeSize % mapSize;
 //      return off % ( dequeSize * mapSize ) / dequeSize;
-//      return ( off / dequeSize ) & ( mapSize - 1 );
    }
 
    MapPtr map;        // pointer to array of pointers to blocks
    size_type mapSize; // size of map array, zero or 2^N
    size_type myOff;   // offset of initial element
    size_type mySize;  // current length of sequence
+
+   pointer spare[ maxSpare ]; // vacated blocks, kept for reuse
+   size_type numSpare;        // number of blocks on the spare list
+   size_type numGrowths;      // times the map was allocated or grown
 };
 
 
 // CLASS TEMPLATE deque
-template< typename Ty >
+template< typename Ty, typename BlockPolicy = DequeDefaultBlock, typename Alloc = std::allocator< Ty > >
 class deque // circular queue of pointers to blocks
 {
 private:
    using MapPtr = Ty **;
-   using ScaryVal = DequeVal< Ty >;
+   using ScaryVal = DequeVal< Ty, BlockPolicy >;
+   using BlockAlloc = typename std::allocator_traits< Alloc >::template rebind_alloc< Ty >;
+   using BlockTraits = std::allocator_traits< BlockAlloc >;
+   using MapAlloc = typename BlockTraits::template rebind_alloc< Ty * >;
+   using MapTraits = std::allocator_traits< MapAlloc >;
 
 public:
    using value_type = Ty;
@@ -328,85 +604,171 @@ public:
    using const_pointer = const value_type *;
    using reference = value_type &;
    using const_reference = const value_type &;
+   using allocator_type = Alloc;
 
    using iterator = DequeIterator< ScaryVal >;
    using const_iterator = DequeConstIterator< ScaryVal >;
 
    // construct empty deque
    deque()
-      : myData()
+      : myData(),
+        myAlloc()
+   {
+   }
+
+   // construct empty deque with allocator
+   explicit deque( const Alloc &al )
+      : myData(),
+        myAlloc( al )
    {
    }
 
+   // construct by moving right: its map and blocks change hands in O(1),
+   // leaving right empty
+   deque( deque &&right ) noexcept
+      : myData( right.myData ),
+        myAlloc( std::move( right.myAlloc ) )
+   {
+      right.myData = ScaryVal();
+   }
+
    // destroy the deque
    ~deque()
    {
       clear();
    }
 
+   // return allocator object for values
+   allocator_type get_allocator() const
+   {
+      return allocator_type( myAlloc );
+   }
+
    // Assigns new contents to the container, replacing its current contents,
    // and modifying its size accordingly.
    deque& operator=( const deque &right )
    {
       if( &right != this ) // avoid self-assignment
       {
-         // elements per block (a power of 2)
-         size_type dequeSize = compDequeSize();
-
-         if( myData.mySize < right.myData.mySize )
-         {  // allocate memory space in the current object
-            size_type newMapSize = 8;
-            while( right.myData.mySize > dequeSize * newMapSize )
-               newMapSize *= 2;
-
-            if( ( myData.myOff % dequeSize == 0 && right.myData.mySize > dequeSize * ( newMapSize - 1 ) &&
-                  myData.mySize <= dequeSize * ( newMapSize - 1 ) ) ||
-                ( myData.myOff % dequeSize > 0 && myData.myOff % dequeSize + right.myData.mySize > dequeSize * newMapSize ) )
-               newMapSize *= 2;
-
-            if( newMapSize > myData.mapSize )
-               enlargeMap( newMapSize ); // reuse the original memory space in the current object
-
-            size_t LeftRow = 0, LeftCol = 0, RightRow = 0, RightCol = 0;
-            for (size_t i = 0; i < right.myData.mySize; i++) {
-                LeftRow = (myData.myOff + i) / dequeSize % myData.mapSize;
-                LeftCol = (myData.myOff + i) % dequeSize;
-                RightRow = (right.myData.myOff + i) / dequeSize % right.myData.mapSize;
-                RightCol = (right.myData.myOff + i) % dequeSize;
-                if (myData.map[LeftRow] == nullptr) {
-                    myData.map[LeftRow] = new value_type[dequeSize]();
-                }
-                myData.map[LeftRow][LeftCol] = right.myData.map[RightRow][RightCol];
-            }
+         if constexpr( BlockTraits::propagate_on_container_copy_assignment::value )
+         {
+            if( myAlloc != right.myAlloc )
+               clear(); // blocks from the old allocator cannot be reused
+            myAlloc = right.myAlloc;
+         }
 
+         resetStorage( right.myData.mySize );
+         size_type dequeSize = compDequeSize(); // elements per block (a power of 2)
+
+         if( std::is_trivially_copyable< value_type >::value && DequeParallel::splits( right.myData.mySize ) )
+         {  // allocate the missing blocks up front, then each worker copies its own run of blocks
+            for( size_type off = myData.myOff; off < myData.myOff + right.myData.mySize; off += dequeSize - off % dequeSize )
+               blockAt( off );
+            DequeParallel::run( right.myData.mySize, dequeSize, [ this, &right ]( size_type first, size_type last )
+            {
+               copyRange( right, first, last );
+            } );
+            myData.mySize = right.myData.mySize;
+         }
 
+         // copy data from right to the current object in one pass, a run of slots
+         // contiguous in both source and destination blocks at a time
+         size_type dest = myData.myOff;
+         size_type src = right.myData.myOff;
+         while( myData.mySize < right.myData.mySize )
+         {
+            size_type destCol = dest % dequeSize;
+            size_type srcCol = src % dequeSize;
+            size_type count = dequeSize - ( destCol > srcCol ? destCol : srcCol );
+            if( count > right.myData.mySize - myData.mySize )
+               count = right.myData.mySize - myData.mySize;
+
+            copyRun( blockAt( dest ) + destCol, right.myData.map[ right.getBlock( src ) ] + srcCol, count );
+
+            myData.mySize += count;
+            dest += count;
+            src += count;
          }
+      }
 
-         myData.mySize = right.myData.mySize;
+      return *this; // enables x = y = z, for example
+   } // end function operator=
 
-         if( right.myData.mySize == 0 )
-             myData.myOff = 0;
-         else
-         {  // copy data from right to the current object
-             size_t LeftRow = 0, LeftCol = 0, RightRow = 0, RightCol = 0;
-             for (size_t i = 0; i < right.myData.mySize; i++) {
-                 LeftRow = (myData.myOff + i) / dequeSize % myData.mapSize;
-                 LeftCol = (myData.myOff + i) % dequeSize;
-                 RightRow = (right.myData.myOff + i) / dequeSize % right.myData.mapSize;
-                 RightCol = (right.myData.myOff + i) % dequeSize;
-                 if (myData.map[LeftRow] == nullptr) {
-                     myData.map[LeftRow] = new value_type[dequeSize]();
-                 }
-                 myData.map[LeftRow][LeftCol] = right.myData.map[RightRow][RightCol];
-             }
-             myData.mySize = right.myData.mySize;
+   // replace the contents with count copies of val, overwriting the live
+   // elements in place and reusing the blocks already held; a block is
+   // allocated only past the current capacity. val may be an element of
+   // this deque
+   void assign( size_type count, const value_type &val )
+   {
+      size_type dequeSize = compDequeSize(); // elements per block (a power of 2)
+      if( myData.mapSize == 0 || ( myData.myOff % dequeSize + count + dequeSize - 1 ) / dequeSize > myData.mapSize - 1 )
+      {  // the map must grow: start over from a copy of val, which may be about to be destroyed
+         value_type copy( val );
+         resetStorage( count );
+         appendCopies( count, copy );
+         return;
+      }
 
+      size_type live = count < myData.mySize ? count : myData.mySize;
+      for( size_type off = myData.myOff; off < myData.myOff + live; )
+      {
+         size_type run = dequeSize - off % dequeSize;
+         if( run > myData.myOff + live - off )
+            run = myData.myOff + live - off;
+         std::fill_n( myData.map[ getBlock( off ) ] + off % dequeSize, run, val );
+         off += run;
+      }
 
+      if( count < myData.mySize )
+      {  // destroy the surplus, now that val has been read; its blocks stay for reuse
+         if( !std::is_trivially_destructible< value_type >::value )
+            for( size_type off = myData.myOff + count; off < myData.myOff + myData.mySize; off++ )
+               destroy( &myData.map[ getBlock( off ) ][ off % dequeSize ] );
+         myData.mySize = count;
+      }
+      else
+         appendCopies( count, val );
+   }
+
+   // replace the contents with [ first, last ), reusing the blocks already
+   // held; a range that can be read twice is measured first, so the map
+   // grows at most once
+   template< typename InIt,
+             typename = typename std::iterator_traits< InIt >::iterator_category >
+   void assign( InIt first, InIt last )
+   {
+      assignRange( first, last, typename std::iterator_traits< InIt >::iterator_category() );
+   }
+
+   // replace the contents with the elements of list
+   void assign( std::initializer_list< value_type > list )
+   {
+      assign( list.begin(), list.end() );
+   }
+
+   // move right into this deque; with an allocator that propagates or compares
+   // equal, the map and blocks change hands in O(1), otherwise the elements are
+   // moved one by one into blocks of this deque's own. right is left empty
+   deque& operator=( deque &&right ) noexcept( BlockTraits::propagate_on_container_move_assignment::value ||
+                                               BlockTraits::is_always_equal::value )
+   {
+      if( &right != this )
+      {
+         clear();
+         if constexpr( BlockTraits::propagate_on_container_move_assignment::value )
+            myAlloc = std::move( right.myAlloc );
+
+         if( BlockTraits::propagate_on_container_move_assignment::value || myAlloc == right.myAlloc )
+         {
+            myData = right.myData;
+            right.myData = ScaryVal();
          }
+         else
+            moveElements( right );
       }
 
-      return *this; // enables x = y = z, for example
-   } // end function operator=
+      return *this;
+   }
 
    // return iterator for beginning of mutable sequence
    iterator begin()
@@ -444,23 +806,104 @@ public:
       return myData.mySize == 0;
    }
 
+   // call func( p, count ) for each run of elements stored contiguously
+   // in one block, in sequence order
+   template< typename Func >
+   void for_each_segment( Func func )
+   {
+      size_type dequeSize = compDequeSize(); // elements per block (a power of 2)
+      size_type off = myData.myOff;
+      for( size_type left = myData.mySize; left > 0; )
+      {
+         size_type col = off % dequeSize;
+         size_type count = dequeSize - col < left ? dequeSize - col : left;
+         func( static_cast< pointer >( myData.map[ getBlock( off ) ] + col ), count );
+         off += count;
+         left -= count;
+      }
+   }
+
+   // call func( p, count ) for each run of elements stored contiguously
+   // in one block, in sequence order
+   template< typename Func >
+   void for_each_segment( Func func ) const
+   {
+      size_type dequeSize = compDequeSize(); // elements per block (a power of 2)
+      size_type off = myData.myOff;
+      for( size_type left = myData.mySize; left > 0; )
+      {
+         size_type col = off % dequeSize;
+         size_type count = dequeSize - col < left ? dequeSize - col : left;
+         func( static_cast< const_pointer >( myData.map[ getBlock( off ) ] + col ), count );
+         off += count;
+         left -= count;
+      }
+   }
+
 // erase all
 void clear()
 {
    if( myData.mapSize > 0 )
    {
+      if( !std::is_trivially_destructible< value_type >::value )
+         for( size_type off = myData.myOff; off < myData.myOff + myData.mySize; off++ )
+            destroy( &myData.map[ getBlock( off ) ][ off % compDequeSize() ] );
+
       for( size_type i = 0; i < myData.mapSize; i++ )
          if( myData.map[ i ] != nullptr )
-            delete[] myData.map[ i ];
-      delete[] myData.map;
+            releaseBlock( myData.map[ i ] );
+      for( size_type i = 0; i < myData.numSpare; i++ )
+         releaseBlock( myData.spare[ i ] );
+      freeMap( myData.map, myData.mapSize );
 
       myData.mapSize = 0;
       myData.mySize = 0;
       myData.myOff = 0;
+      myData.numSpare = 0;
       myData.map = MapPtr();
    }
 }
 
+   // erase all, keeping the map and every block for reuse
+   void clear_keep_capacity()
+   {
+      if( !std::is_trivially_destructible< value_type >::value )
+         for( size_type off = myData.myOff; off < myData.myOff + myData.mySize; off++ )
+            destroy( &myData.map[ getBlock( off ) ][ off % compDequeSize() ] );
+
+      myData.myOff = 0;
+      myData.mySize = 0;
+   }
+
+   // report the memory the deque holds; O( mapSize ), without allocating
+   DequeMemoryStats memory_stats() const
+   {
+      size_type dequeSize = compDequeSize(); // elements per block (a power of 2)
+      DequeMemoryStats stats = DequeMemoryStats();
+      stats.mapSlots = myData.mapSize;
+      for( size_type i = 0; i < myData.mapSize; i++ )
+         if( myData.map[ i ] != nullptr )
+            stats.blocks++;
+      stats.nullSlots = myData.mapSize - stats.blocks;
+      stats.spareBlocks = myData.numSpare;
+      if( myData.mySize > 0 )
+      {
+         stats.liveBlocks = ( myData.myOff + myData.mySize - 1 ) / dequeSize - myData.myOff / dequeSize + 1;
+         if( stats.liveBlocks > myData.mapSize ) // first and last element share a block
+            stats.liveBlocks = myData.mapSize;
+         stats.frontSlack = myData.myOff % dequeSize;
+         stats.backSlack = ( dequeSize - ( myData.myOff + myData.mySize ) % dequeSize ) % dequeSize;
+      }
+
+      size_type slots = ( stats.blocks + stats.spareBlocks ) * dequeSize;
+      stats.mapBytes = myData.mapSize * sizeof( pointer );
+      stats.blockBytes = slots * sizeof( value_type );
+      stats.totalBytes = stats.mapBytes + stats.blockBytes;
+      stats.occupancy = slots == 0 ? 0 : static_cast< double >( myData.mySize ) / slots;
+      stats.growthEvents = myData.numGrowths;
+      return stats;
+   }
+
 private:
 
    // determine block from offset
@@ -474,32 +917,260 @@ private:
    {
       size_type oldMapSize = myData.mapSize;
       myData.mapSize = newMapSize;
-      value_type **newMap = new value_type * [ myData.mapSize ]();
+      MapPtr newMap = allocMap( myData.mapSize );
 
       size_t dequeSize = compDequeSize();
-      if( myData.mySize > 0 )
+      if( oldMapSize > 0 ) // relink every old block, even with no element, so none leaks
       {
-          size_t row = (myData.myOff) / dequeSize % myData.mapSize;
-          for (size_t i = 0; i < oldMapSize; i++) {
-              newMap[row] = myData.map[i];
-              row++;
-              row %= myData.mapSize;
-          }
+          // each block keeps its place relative to myOff, so live elements keep their offsets
+          size_t block = myData.myOff / dequeSize;
+          for (size_t i = 0; i < oldMapSize; i++, block++)
+              newMap[block & (myData.mapSize - 1)] = myData.map[block & (oldMapSize - 1)];
 
 
-         delete[] myData.map;
+         freeMap( myData.map, oldMapSize );
       }
 
       myData.map = newMap;
+      ++myData.numGrowths;
+   }
+
+   // destroy the elements and make room for newSize elements, growing the
+   // map by the copy-assignment rule; every block is kept for reuse
+   void resetStorage( size_type newSize )
+   {
+      size_type dequeSize = compDequeSize(); // elements per block (a power of 2)
+
+      // destroy the current elements a block at a time; their blocks are reused below
+      if( !std::is_trivially_destructible< value_type >::value )
+         for_each_segment( [ this ]( pointer p, size_type count )
+         {
+            for( size_type i = 0; i < count; i++ )
+               destroy( p + i );
+         } );
+      size_type oldSize = myData.mySize;
+      myData.mySize = 0;
+
+      if( oldSize < newSize )
+      {  // allocate memory space in the current object
+         size_type newMapSize = 8;
+         while( newSize > dequeSize * newMapSize )
+            newMapSize *= 2;
+
+         if( ( myData.myOff % dequeSize == 0 && newSize > dequeSize * ( newMapSize - 1 ) &&
+               oldSize <= dequeSize * ( newMapSize - 1 ) ) ||
+             ( myData.myOff % dequeSize > 0 && myData.myOff % dequeSize + newSize > dequeSize * newMapSize ) )
+            newMapSize *= 2;
+
+         if( newMapSize > myData.mapSize )
+            enlargeMap( newMapSize ); // reuse the original memory space in the current object
+      }
+
+      if( newSize == 0 )
+         myData.myOff = 0;
+   }
+
+   // return the block holding offset off, allocating it if it is missing
+   pointer blockAt( size_type off )
+   {
+      MapPtr block = myData.map + getBlock( off );
+      if( *block == nullptr )
+         *block = allocBlock(); // only the missing blocks are allocated
+      return *block;
+   }
+
+   // construct copies of val behind the last element until there are count;
+   // their slots lie in the map already
+   void appendCopies( size_type count, const value_type &val )
+   {
+      size_type dequeSize = compDequeSize(); // elements per block (a power of 2)
+      for( size_type dest = myData.myOff + myData.mySize; myData.mySize < count; )
+      {
+         size_type run = dequeSize - dest % dequeSize;
+         if( run > count - myData.mySize )
+            run = count - myData.mySize;
+         fillRun( blockAt( dest ) + dest % dequeSize, run, val );
+         myData.mySize += run;
+         dest += run;
+      }
+   }
+
+   // append [ first, last ) to this deque, which starts at offset 0, when the
+   // range can be read only once; the map grows as the blocks fill up
+   template< typename InIt >
+   void appendRange( InIt first, InIt last )
+   {
+      size_type dequeSize = compDequeSize(); // elements per block (a power of 2)
+      for( ; first != last; ++first )
+      {
+         size_type dest = myData.myOff + myData.mySize;
+         if( dest % dequeSize == 0 && myData.mySize / dequeSize + 2 > myData.mapSize ) // keep a block to spare
+            enlargeMap( myData.mapSize > 0 ? 2 * myData.mapSize : 8 );
+         construct( blockAt( dest ) + dest % dequeSize, *first );
+         ++myData.mySize;
+      }
+   }
+
+   // replace the contents with [ first, last ), sized up front
+   template< typename FwdIt >
+   void assignRange( FwdIt first, FwdIt last, std::forward_iterator_tag )
+   {
+      size_type count = static_cast< size_type >( std::distance( first, last ) );
+      resetStorage( count );
+      for( size_type dest = myData.myOff; first != last; ++first, ++dest )
+      {
+         construct( blockAt( dest ) + dest % compDequeSize(), *first );
+         ++myData.mySize;
+      }
+   }
+
+   // replace the contents with [ first, last ) when the range can be read only once
+   template< typename InIt >
+   void assignRange( InIt first, InIt last, std::input_iterator_tag )
+   {
+      resetStorage( 0 );
+      appendRange( first, last );
+   }
+
+   // construct count copies of val in the raw slots at p; fill_n over
+   // trivially copyable elements compiles to wide stores of val
+   void fillRun( pointer p, size_type count, const value_type &val )
+   {
+      if constexpr( std::is_trivially_copyable< value_type >::value )
+         std::fill_n( p, count, val );
+      else
+      {
+         size_type i = 0;
+         try
+         {
+            for( ; i < count; i++ )
+               construct( p + i, val );
+         }
+         catch( ... )
+         {  // all or nothing: the caller counts whole runs
+            while( i > 0 )
+               destroy( p + --i );
+            throw;
+         }
+      }
+   }
+
+   // copy the elements at positions [ first, last ) of right to the same
+   // positions here, a run contiguous in both blocks at a time; the
+   // destination blocks must already be allocated
+   void copyRange( const deque &right, size_type first, size_type last )
+   {
+      size_type dequeSize = compDequeSize(); // elements per block (a power of 2)
+      while( first < last )
+      {
+         size_type dest = myData.myOff + first;
+         size_type src = right.myData.myOff + first;
+         size_type count = dequeSize - ( dest % dequeSize > src % dequeSize ? dest % dequeSize : src % dequeSize );
+         if( count > last - first )
+            count = last - first;
+         copyRun( myData.map[ getBlock( dest ) ] + dest % dequeSize,
+                  right.myData.map[ right.getBlock( src ) ] + src % dequeSize, count );
+         first += count;
+      }
+   }
+
+   // copy count contiguous elements from src into the raw slots at dest
+   void copyRun( pointer dest, const_pointer src, size_type count )
+   {
+      if constexpr( std::is_trivially_copyable< value_type >::value )
+         std::memcpy( dest, src, count * sizeof( value_type ) );
+      else
+      {
+         size_type i = 0;
+         try
+         {
+            for( ; i < count; i++ )
+               construct( dest + i, src[ i ] );
+         }
+         catch( ... )
+         {  // all or nothing: the caller counts whole runs
+            while( i > 0 )
+               destroy( dest + --i );
+            throw;
+         }
+      }
+   }
+
+   // construct an element from args in the raw slot p
+   template< typename... Args >
+   void construct( pointer p, Args &&...args )
+   {
+      BlockTraits::construct( myAlloc, p, std::forward< Args >( args )... );
+   }
+
+   // destroy the element in slot p, leaving the slot raw
+   void destroy( pointer p )
+   {
+      BlockTraits::destroy( myAlloc, p );
+   }
+
+   // allocate raw storage for one block; no element is constructed
+   pointer allocBlock()
+   {
+      return BlockTraits::allocate( myAlloc, compDequeSize() );
+   }
+
+   // release a block of raw storage whose elements are all destroyed
+   void releaseBlock( pointer block )
+   {
+      BlockTraits::deallocate( myAlloc, block, compDequeSize() );
+   }
+
+   // allocate a map of count null block pointers
+   MapPtr allocMap( size_type count )
+   {
+      MapAlloc mapAlloc( myAlloc );
+      MapPtr map = MapTraits::allocate( mapAlloc, count );
+      for( size_type i = 0; i < count; i++ )
+         map[ i ] = nullptr;
+      return map;
+   }
+
+   // release a map of count block pointers
+   void freeMap( MapPtr map, size_type count )
+   {
+      MapAlloc mapAlloc( myAlloc );
+      MapTraits::deallocate( mapAlloc, map, count );
+   }
+
+   // move right's elements one by one to the same offsets in a map and blocks
+   // of this (empty) deque's own, then clear right. Each element is counted
+   // as soon as it is built, so a throw leaves this deque valid
+   void moveElements( deque &right )
+   {
+      size_type dequeSize = compDequeSize(); // elements per block (a power of 2)
+      if( right.myData.mySize > 0 )
+      {
+         myData.map = allocMap( right.myData.mapSize );
+         myData.mapSize = right.myData.mapSize;
+         myData.myOff = right.myData.myOff;
+         ++myData.numGrowths;
+         for( size_type off = myData.myOff; off < myData.myOff + right.myData.mySize; off++ )
+         {
+            MapPtr block = myData.map + getBlock( off );
+            if( *block == nullptr )
+               *block = allocBlock();
+            construct( &( *block )[ off % dequeSize ],
+                       std::move( right.myData.map[ right.getBlock( off ) ][ off % dequeSize ] ) );
+            ++myData.mySize;
+         }
+      }
+      right.clear();
    }
 
-   size_type compDequeSize()
+   // elements per block (a power of 2)
+   static constexpr size_type compDequeSize()
    {
-      return sizeof( value_type ) <= 1 ? 16 : sizeof( value_type ) <= 2 ? 8 :
-             sizeof( value_type ) <= 4 ?  4 : sizeof( value_type ) <= 8 ? 2 : 1;
+      return ScaryVal::dequeSize;
    }
 
    ScaryVal myData;
+   BlockAlloc myAlloc; // allocates blocks and elements; rebound for the map
 };
 
 #endif
\ No newline at end of file
@@ -1,6 +1,56 @@
 #ifndef DEQUE_H
 #define DEQUE_H
 
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// CLASS TEMPLATE DequeBlockBytes
+// block geometry policy: each block spans Bytes bytes, rounded down to
+// a power of 2 elements (at least one element per block)
+template< size_t Bytes >
+struct DequeBlockBytes
+{
+   template< typename Ty >
+   static constexpr size_t elements()
+   {
+      return floorPow2( Bytes / sizeof( Ty ) );
+   }
+
+private:
+   static constexpr size_t floorPow2( size_t n )
+   {
+      return n <= 1 ? 1 : 2 * floorPow2( n / 2 );
+   }
+};
+
+// CLASS TEMPLATE DequeBlockElements
+// block geometry policy: each block holds Count elements
+template< size_t Count >
+struct DequeBlockElements
+{
+   static_assert( Count > 0 && ( Count & ( Count - 1 ) ) == 0,
+                  "elements per block must be a power of 2" );
+
+   template< typename Ty >
+   static constexpr size_t elements()
+   {
+      return Count;
+   }
+};
+
+// 16 bytes per block: 16, 8, 4, 2 or 1 elements for 1, 2, 4, 8 or >8 byte types
+using DequeDefaultBlock = DequeBlockBytes< 16 >;
+
 // CLASS TEMPLATE DequeConstIterator
 template< typename MyDeque >
 class DequeConstIterator // iterator for nonmutable deque
@@ -9,6 +59,7 @@ private:
    using size_type = typename MyDeque::size_type;
 
 public:
+   using iterator_category = std::random_access_iterator_tag;
    using value_type = typename MyDeque::value_type;
    using difference_type = typename MyDeque::difference_type;
    using pointer = typename MyDeque::const_pointer;
@@ -16,21 +67,28 @@ public:
 
    // construct with null pointer
    DequeConstIterator()
-      : myOff( 0 ),
-      myCont( nullptr )
+      : myCont( nullptr ),
+        myOff( 0 ),
+        myCur( nullptr ),
+        myFirst( nullptr ),
+        myLast( nullptr )
    {
    }
 
    // construct with offset off in *pDeque
    DequeConstIterator( size_type off, const MyDeque *pDeque )
-      : myOff( off ),
-      myCont( pDeque )
+      : myCont( pDeque ),
+        myOff( off )
    {
+      setBlock();
    }
 
    DequeConstIterator( const DequeConstIterator &right ) // copy constructor
-      : myOff( right.myOff ),
-      myCont( right.myCont )
+      : myCont( right.myCont ),
+        myOff( right.myOff ),
+        myCur( right.myCur ),
+        myFirst( right.myFirst ),
+        myLast( right.myLast )
    {
    }
 
@@ -45,32 +103,28 @@ public:
       {
          myCont = right.myCont;
          myOff = right.myOff;
+         myCur = right.myCur;
+         myFirst = right.myFirst;
+         myLast = right.myLast;
       }
       return *this; // enables x = y = z, for example
    }
 
    reference operator*() const
    {
-      // elements per block (a power of 2)
-      size_type dequeSize = sizeof( value_type ) <= 1 ? 16 :
-                            sizeof( value_type ) <= 2 ?  8 :
-                            sizeof( value_type ) <= 4 ?  4 :
-                            sizeof( value_type ) <= 8 ?  2 : 1;
-
-//      size_type block = myOff % ( dequeSize * myCont->mapSize ) / dequeSize;
-      size_type block = myCont->getBlock( myOff );
-      size_type off = myOff % dequeSize;
-      return myCont->map[ block ][ off ];
+      return *myCur;
    }
 
    pointer operator->() const
    {
-      return &( operator*() );
+      return myCur;
    }
 
    DequeConstIterator& operator++() // preincrement
    {
       ++myOff;
+      if( ++myCur == myLast ) // stepped off the end of the block
+         setBlock();
       return *this;
    }
 
@@ -84,6 +138,10 @@ public:
    DequeConstIterator& operator--() // predecrement
    {
       --myOff;
+      if( myCur == myFirst ) // step back into the previous block
+         setBlock();
+      else
+         --myCur;
       return *this;
    }
 
@@ -98,6 +156,11 @@ public:
    DequeConstIterator& operator+=( const difference_type off )
    {
       myOff += off;
+      difference_type col = ( myCur - myFirst ) + off;
+      if( myFirst != nullptr && col >= 0 && col < static_cast< difference_type >( MyDeque::dequeSize ) )
+         myCur += off; // still inside the cached block
+      else
+         setBlock();
       return *this;
    }
 
@@ -170,6 +233,26 @@ public:
 
    const MyDeque *myCont; // keep a pointer to deque
    size_type myOff;       // offset of element in deque
+
+private:
+   // cache the bounds of the block holding myOff, so that dereferencing and
+   // stepping inside a block never touch the map
+   void setBlock()
+   {
+      if( myCont != nullptr && myCont->map != nullptr &&
+          myCont->map[ myCont->getBlock( myOff ) ] != nullptr )
+      {
+         myFirst = myCont->map[ myCont->getBlock( myOff ) ];
+         myLast = myFirst + MyDeque::dequeSize;
+         myCur = myFirst + myOff % MyDeque::dequeSize;
+      }
+      else // no block allocated there yet, e.g. end() on a block boundary
+         myCur = myFirst = myLast = nullptr;
+   }
+
+   pointer myCur;   // current element
+   pointer myFirst; // beginning of the block holding the current element
+   pointer myLast;  // end of the block holding the current element
 };
 
 
@@ -271,8 +354,188 @@ public:
    }
 };
 
+// memory held by a deque, as reported by deque::memory_stats()
+struct DequeMemoryStats
+{
+   size_t mapBytes;     // bytes in the map
+   size_t blockBytes;   // bytes in allocated blocks, spare blocks included
+   size_t totalBytes;   // mapBytes + blockBytes
+   size_t mapSlots;     // slots in the map
+   size_t nullSlots;    // map slots without a block
+   size_t blocks;       // blocks in the map
+   size_t liveBlocks;   // blocks holding at least one element
+   size_t spareBlocks;  // blocks on the spare list
+   size_t frontSlack;   // raw slots in the first live block, before the first element
+   size_t backSlack;    // raw slots in the last live block, after the last element
+   double occupancy;    // elements per slot in allocated blocks; 0 without blocks
+   size_t growthEvents; // times the map was allocated or grown
+};
+
+// opt-in parallel copy and fill of trivially copyable elements: an operation
+// on at least threshold elements hands each of threads workers its own run of
+// blocks. threads == 1, the default, keeps every operation on the calling thread.
+// The workers live in one pool shared by every deque, started on first use and
+// grown as threads rises; either setting may change while deques are in use
+struct DequeParallel
+{
+   static inline std::atomic< unsigned > threads{ 1 };             // workers, the calling thread included
+   static inline std::atomic< size_t > threshold{ size_t( 1 ) << 24 }; // fewest elements worth splitting
+
+   // return whether an operation on count elements is split across workers
+   static bool splits( size_t count )
+   {
+      return count > 0 && threads.load( std::memory_order_relaxed ) > 1 &&
+             count >= threshold.load( std::memory_order_relaxed );
+   }
+
+   // call work( first, last ) on one range per worker, the ranges covering
+   // [ 0, count ) with every inner boundary a multiple of grain; the calling
+   // thread takes the first range and then waits for the others
+   template< typename Work >
+   static void run( size_t count, size_t grain, Work work )
+   {
+      if( count == 0 )
+         return;
+
+      size_t units = ( count + grain - 1 ) / grain;
+      size_t wanted = threads.load( std::memory_order_relaxed );
+      size_t workers = wanted < units ? wanted : units;
+      Batch batch;
+      try
+      {
+         for( size_t w = 1; w < workers; w++ )
+         {
+            size_t first = units * w / workers * grain;
+            size_t last = units * ( w + 1 ) / workers * grain;
+            if( last > count )
+               last = count;
+            pool().submit( batch, workers - 1, [ &work, first, last ]() { work( first, last ); } );
+         }
+         size_t last = units / workers * grain;
+         work( size_t( 0 ), last < count ? last : count );
+      }
+      catch( ... )
+      {  // the ranges already handed out refer to work: let them finish first
+         batch.wait();
+         throw;
+      }
+      batch.wait();
+      if( batch.error )
+         std::rethrow_exception( batch.error );
+   }
+
+private:
+   // the ranges of one call to run still in the pool, and the first
+   // exception any of them raised
+   struct Batch
+   {
+      std::mutex mutex;
+      std::condition_variable done;
+      size_t pending = 0;
+      std::exception_ptr error;
+
+      // record that one range finished, raising error if it is not null
+      void finish( std::exception_ptr rangeError )
+      {
+         std::lock_guard< std::mutex > lock( mutex );
+         if( rangeError && !error )
+            error = rangeError;
+         if( --pending == 0 )
+            done.notify_all();
+      }
+
+      // block until every range handed out has finished
+      void wait()
+      {
+         std::unique_lock< std::mutex > lock( mutex );
+         done.wait( lock, [ this ]() { return pending == 0; } );
+      }
+   };
+
+   // worker threads serving ranges from a shared list, joined at exit
+   class Pool
+   {
+   public:
+      ~Pool()
+      {
+         {
+            std::lock_guard< std::mutex > lock( mutex );
+            stopping = true;
+         }
+         ready.notify_all();
+         for( std::thread &worker : workers )
+            worker.join();
+      }
+
+      // queue task as a range of batch, first starting workers until there
+      // are at least wanted; a throw leaves batch without the task
+      void submit( Batch &batch, size_t wanted, std::function< void() > task )
+      {
+         {
+            std::lock_guard< std::mutex > lock( mutex );
+            while( workers.size() < wanted )
+               workers.emplace_back( [ this ]() { serve(); } );
+            tasks.push_back( Task{ &batch, std::move( task ) } );
+
+            // counted before any worker can take the task
+            std::lock_guard< std::mutex > batchLock( batch.mutex );
+            ++batch.pending;
+         }
+         ready.notify_one();
+      }
+
+   private:
+      struct Task
+      {
+         Batch *batch;
+         std::function< void() > work;
+      };
+
+      // run queued tasks until the pool is destroyed
+      void serve()
+      {
+         for( ;; )
+         {
+            Task task;
+            {
+               std::unique_lock< std::mutex > lock( mutex );
+               ready.wait( lock, [ this ]() { return stopping || !tasks.empty(); } );
+               if( tasks.empty() )
+                  return;
+               task = std::move( tasks.back() );
+               tasks.pop_back();
+            }
+
+            std::exception_ptr error;
+            try
+            {
+               task.work();
+            }
+            catch( ... )
+            {
+               error = std::current_exception();
+            }
+            task.batch->finish( error );
+         }
+      }
+
+      std::mutex mutex;
+      std::condition_variable ready;
+      std::vector< std::thread > workers;
+      std::vector< Task > tasks; // taken from the back; their order does not matter
+      bool stopping = false;
+   };
+
+   // the pool every deque shares
+   static Pool &pool()
+   {
+      static Pool instance;
+      return instance;
+   }
+};
+
 // CLASS TEMPLATE DequeVal
-template< typename Ty >
+template< typename Ty, typename BlockPolicy = DequeDefaultBlock >
 class DequeVal // base class for deque to hold data
 {
 public:
@@ -284,42 +547,67 @@ public:
    using reference = value_type &;
    using const_reference = const value_type &;
    using MapPtr = Ty **;
+   using RefCount = std::atomic< size_type >; // shared by deques that may live on different threads
+
+   // elements per block (a power of 2)
+   static constexpr size_type dequeSize = BlockPolicy::template elements< Ty >();
+
+   // most blocks kept on the spare list; freed blocks beyond it go back to the heap
+   static constexpr size_type maxSpare = 8;
 
    DequeVal() // initialize values
       : map(),
       mapSize( 0 ),
       myOff( 0 ),
-      mySize( 0 )
+      mySize( 0 ),
+      spare(),
+      numSpare( 0 ),
+      numGrowths( 0 ),
+      refs(),
+      slab( nullptr ),
+      slabBlocks( 0 ),
+      slabRefs( nullptr )
    {
    }
 
    // determine block from offset
    size_type getBlock( size_type off ) const
    {
-      // elements per block (a power of 2)
-      size_type dequeSize = sizeof( value_type ) <= 1 ? 16 :
-                            sizeof( value_type ) <= 2 ?  8 :
-                            sizeof( value_type ) <= 4 ?  4 :
-                            sizeof( value_type ) <= 8 ?  2 : 1;
-
-      return off % ( dequeSize * mapSize ) / dequeSize;
-//      return ( off / dequeSize ) & ( mapSize - 1 );
+      return ( off / dequeSize ) & ( mapSize - 1 ); // mapSize is zero or 2^N
+//      return off % ( dequeSize * mapSize ) / dequeSize;
    }
 
    MapPtr map;        // pointer to array of pointers to blocks
    size_type mapSize; // size of map array, zero or 2^N
    size_type myOff;   // offset of initial element
    size_type mySize;  // current length of sequence
+
+   pointer spare[ maxSpare ]; // vacated blocks, kept for reuse
+   size_type numSpare;        // number of blocks on the spare list
+   size_type numGrowths;      // times the map was allocated or grown
+   RefCount **refs;           // per map slot, the share count of a copy-on-write block, or null
+   pointer slab;              // storage the copy constructor carved its blocks from
+   size_type slabBlocks;      // number of blocks in slab
+   RefCount *slabRefs;        // number of deques holding blocks of slab, once a snapshot shares it
 };
 
 
 // CLASS TEMPLATE deque
-template< typename Ty >
+template< typename Ty, typename BlockPolicy = DequeDefaultBlock, typename Alloc = std::allocator< Ty > >
 class deque // circular queue of pointers to blocks
 {
 private:
    using MapPtr = Ty **;
-   using ScaryVal = DequeVal< Ty >;
+   using ScaryVal = DequeVal< Ty, BlockPolicy >;
+   using BlockAlloc = typename std::allocator_traits< Alloc >::template rebind_alloc< Ty >;
+   using BlockTraits = std::allocator_traits< BlockAlloc >;
+   using MapAlloc = typename BlockTraits::template rebind_alloc< Ty * >;
+   using MapTraits = std::allocator_traits< MapAlloc >;
+   using RefCount = typename ScaryVal::RefCount;
+   using RefAlloc = typename BlockTraits::template rebind_alloc< RefCount >;
+   using RefTraits = std::allocator_traits< RefAlloc >;
+   using RefMapAlloc = typename BlockTraits::template rebind_alloc< RefCount * >;
+   using RefMapTraits = std::allocator_traits< RefMapAlloc >;
 
 public:
    using value_type = Ty;
@@ -329,64 +617,141 @@ public:
    using const_pointer = const value_type *;
    using reference = value_type &;
    using const_reference = const value_type &;
+   using allocator_type = Alloc;
 
    using iterator = DequeIterator< ScaryVal >;
    using const_iterator = DequeConstIterator< ScaryVal >;
 
    // construct empty deque
    deque()
-      : myData()
+      : myData(),
+        myAlloc()
+   {
+   }
+
+   // construct empty deque with allocator
+   explicit deque( const Alloc &al )
+      : myData(),
+        myAlloc( al )
    {
    }
 
    // construct by copying right
    deque( const deque &right )
-      : myData()
+      : myData(),
+        myAlloc( BlockTraits::select_on_container_copy_construction( right.myAlloc ) )
    {
       if( right.myData.mySize > 0 )
       {
-         size_type dequeSize = compDequeSize();
+         size_type dequeSize = compDequeSize(); // elements per block (a power of 2)
 
-         myData.mySize = right.myData.mySize;
          myData.mapSize = 8;
-         while( myData.mySize > dequeSize * ( myData.mapSize - 1 ) )
+         while( right.myData.mySize > dequeSize * ( myData.mapSize - 1 ) )
             myData.mapSize *= 2;
-         size_type elementCounter = 0;
-         //create 1-dimension dynamic array
-         myData.map = new pointer[myData.mapSize]();
-         //create 2-dimension dynamic array
-         for (size_t i = 0; i < myData.mapSize; i++) {
-             myData.map[i] = new value_type[dequeSize]();
-             elementCounter += dequeSize;
-             if (elementCounter >= right.myData.mySize) {
-                 break;
-             }
+         myData.map = allocMap( myData.mapSize );
+         ++myData.numGrowths;
+
+         // a constructor that throws never runs ~deque, so on a throw destroy
+         // the elements copied so far and release the slab and the map here
+         try
+         {
+            // carve every block out of one contiguous slab; the copy starts at
+            // offset 0, so its elements occupy one unbroken run of the slab
+            myData.slabBlocks = ( right.myData.mySize + dequeSize - 1 ) / dequeSize;
+            myData.slab = BlockTraits::allocate( myAlloc, myData.slabBlocks * dequeSize );
+            for( size_type i = 0; i < myData.slabBlocks; i++ )
+               myData.map[ i ] = myData.slab + i * dequeSize;
+
+            if( std::is_trivially_copyable< value_type >::value && DequeParallel::splits( right.myData.mySize ) )
+            {  // each worker copies its own run of blocks of the slab
+               DequeParallel::run( right.myData.mySize, dequeSize, [ this, &right ]( size_type first, size_type last )
+               {
+                  copyRange( right, first, last );
+               } );
+               myData.mySize = right.myData.mySize;
+            }
+            else // copy one source segment at a time; runs split only at the blocks of right
+               right.for_each_segment( [ this ]( const_pointer p, size_type count )
+               {
+                  copyRun( myData.slab + myData.mySize, p, count );
+                  myData.mySize += count;
+               } );
          }
-         elementCounter = 0;//initial
-         //copy the elements from right-hand-side object
-         size_t rightStart = right.myData.myOff / dequeSize, //example 56/4=14,57/4=14
-             rightSubStart = right.myData.myOff % dequeSize,//56%4=0, 57%4=1
-             leftIndex = 0, rightIndex = 0;
-         for (size_t i = 0; elementCounter!=myData.mySize; i++) {
-             for (size_t j = 0; j < dequeSize; j++) {
-                 rightIndex = (j + rightSubStart);
-                 if (rightIndex >= dequeSize) {
-                     leftIndex = (i + rightStart + 1) % right.myData.mapSize;
-                     rightIndex -=dequeSize;
-                 }
-                 else {
-                     leftIndex = (i + rightStart) % right.myData.mapSize;
-                 }
-                 myData.map[i][j] = right.myData.map[leftIndex][rightIndex];
-                 //before line problem : if j+rightSubStart>=4, then start need plus 1
-                 elementCounter++;
-                 if (elementCounter == myData.mySize) {
-                     break;
-                 }
-             }
+         catch( ... )
+         {
+            clear();
+            throw;
          }
+      }
+   }
 
+   // return a copy-on-write copy in O( mapSize ): it gets a map of its own but
+   // shares every block holding elements with this deque. Whichever deque then
+   // writes to a shared block through modify() clones just that block. Writes
+   // through a mutable iterator cannot be tracked, so begin(), end() and the
+   // non-const for_each_segment clone every shared block up front, an O( size )
+   // copy; read through cbegin() and cend() or a const deque to keep sharing.
+   // The share counts are atomic, so the snapshot and this deque may each be
+   // written, copied or destroyed on its own thread
+   deque snapshot()
+   {
+      deque copy( myAlloc ); // shared blocks must go back to the same allocator
+      if( myData.mySize > 0 )
+      {
+         size_type dequeSize = compDequeSize(); // elements per block (a power of 2)
+         if( myData.refs == nullptr )
+            myData.refs = allocRefs( myData.mapSize );
+
+         copy.myData.map = copy.allocMap( myData.mapSize );
+         copy.myData.refs = copy.allocRefs( myData.mapSize );
+         copy.myData.mapSize = myData.mapSize;
+         copy.myData.myOff = myData.myOff;
+         copy.myData.mySize = myData.mySize;
+         ++copy.myData.numGrowths;
+         if( myData.slab != nullptr ) // shared blocks may lie in the slab; it goes with the last holder
+         {
+            if( myData.slabRefs == nullptr )
+               myData.slabRefs = allocRef();
+            myData.slabRefs->fetch_add( 1, std::memory_order_relaxed );
+            copy.myData.slab = myData.slab;
+            copy.myData.slabBlocks = myData.slabBlocks;
+            copy.myData.slabRefs = myData.slabRefs;
+         }
+
+         size_type first = myData.myOff / dequeSize; // first block in use
+         size_type numBlocks = ( myData.myOff + myData.mySize - 1 ) / dequeSize - first + 1;
+         if( numBlocks > myData.mapSize ) // first and last element share a block
+            numBlocks = myData.mapSize;
+         for( size_type block = first; block < first + numBlocks; block++ )
+         {
+            size_type slot = block & ( myData.mapSize - 1 );
+            if( myData.refs[ slot ] == nullptr )
+               myData.refs[ slot ] = allocRef();
+            myData.refs[ slot ]->fetch_add( 1, std::memory_order_relaxed );
+            copy.myData.map[ slot ] = myData.map[ slot ];
+            copy.myData.refs[ slot ] = myData.refs[ slot ];
+         }
       }
+      return copy;
+   }
+
+   // return a reference for writing to the element at position pos, cloning
+   // its block first if it is shared with a snapshot
+   reference modify( size_type pos )
+   {
+      size_type off = myData.myOff + pos;
+      if( myData.refs != nullptr && myData.refs[ getBlock( off ) ] != nullptr )
+         unshareBlock( getBlock( off ) );
+      return myData.map[ getBlock( off ) ][ off % compDequeSize() ];
+   }
+
+   // construct by moving right: its map and blocks change hands in O(1),
+   // leaving right empty
+   deque( deque &&right ) noexcept
+      : myData( right.myData ),
+        myAlloc( std::move( right.myAlloc ) )
+   {
+      right.myData = ScaryVal();
    }
 
    // destroy the deque
@@ -395,9 +760,43 @@ public:
       clear();
    }
 
-   // return iterator for beginning of mutable sequence
+   // return allocator object for values
+   allocator_type get_allocator() const
+   {
+      return allocator_type( myAlloc );
+   }
+
+   // move right into this deque; with an allocator that propagates or compares
+   // equal, the map and blocks change hands in O(1), otherwise the elements are
+   // moved one by one into blocks of this deque's own. right is left empty
+   deque& operator=( deque &&right ) noexcept( BlockTraits::propagate_on_container_move_assignment::value ||
+                                               BlockTraits::is_always_equal::value )
+   {
+      if( &right != this )
+      {
+         clear();
+         if constexpr( BlockTraits::propagate_on_container_move_assignment::value )
+            myAlloc = std::move( right.myAlloc );
+
+         if( BlockTraits::propagate_on_container_move_assignment::value || myAlloc == right.myAlloc )
+         {
+            myData = right.myData;
+            right.myData = ScaryVal();
+         }
+         else
+            moveElements( right );
+      }
+
+      return *this;
+   }
+
+   // return iterator for beginning of mutable sequence. Writes through it
+   // cannot be tracked, so every block shared with a snapshot is cloned first:
+   // an O( size ) copy even for a loop that only reads. Read a snapshot
+   // through cbegin() and cend() instead, which leave the blocks shared
    iterator begin()
    {
+      unshareAll();
       return iterator( myData.myOff, &myData );
    }
 
@@ -407,9 +806,11 @@ public:
       return const_iterator( myData.myOff, &myData );
    }
 
-   // return iterator for end of mutable sequence
+   // return iterator for end of mutable sequence; like begin(), it first
+   // clones every shared block, so read a snapshot through cend() instead
    iterator end()
    {
+      unshareAll();
       return iterator( myData.myOff + myData.mySize, &myData );
    }
 
@@ -419,27 +820,132 @@ public:
       return const_iterator( myData.myOff + myData.mySize, &myData );
    }
 
+   // return iterator for beginning of nonmutable sequence; shared blocks stay shared
+   const_iterator cbegin() const
+   {
+      return begin();
+   }
+
+   // return iterator for end of nonmutable sequence; shared blocks stay shared
+   const_iterator cend() const
+   {
+      return end();
+   }
+
    iterator makeIter( const_iterator where ) const
    {
       return iterator( where.myOff, &myData );
    }
 
+   // call func( p, count ) for each run of elements stored contiguously
+   // in one block, in sequence order. func may write, so every block shared
+   // with a snapshot is cloned first; call it through a const deque to read
+   // a snapshot without that O( size ) copy
+   template< typename Func >
+   void for_each_segment( Func func )
+   {
+      unshareAll();
+      size_type dequeSize = compDequeSize(); // elements per block (a power of 2)
+      size_type off = myData.myOff;
+      for( size_type left = myData.mySize; left > 0; )
+      {
+         size_type col = off % dequeSize;
+         size_type count = dequeSize - col < left ? dequeSize - col : left;
+         func( static_cast< pointer >( myData.map[ getBlock( off ) ] + col ), count );
+         off += count;
+         left -= count;
+      }
+   }
+
+   // call func( p, count ) for each run of elements stored contiguously
+   // in one block, in sequence order
+   template< typename Func >
+   void for_each_segment( Func func ) const
+   {
+      size_type dequeSize = compDequeSize(); // elements per block (a power of 2)
+      size_type off = myData.myOff;
+      for( size_type left = myData.mySize; left > 0; )
+      {
+         size_type col = off % dequeSize;
+         size_type count = dequeSize - col < left ? dequeSize - col : left;
+         func( static_cast< const_pointer >( myData.map[ getBlock( off ) ] + col ), count );
+         off += count;
+         left -= count;
+      }
+   }
+
    // erase all
    void clear()
    {
       if( myData.mapSize > 0 )
       {
+         dropShares();
+         if( !std::is_trivially_destructible< value_type >::value )
+            for( size_type off = myData.myOff; off < myData.myOff + myData.mySize; off++ )
+               if( myData.map[ getBlock( off ) ] != nullptr ) // null once left to a snapshot
+                  destroy( &myData.map[ getBlock( off ) ][ off % compDequeSize() ] );
+
          for( size_type i = 0; i < myData.mapSize; i++ )
-            delete[] myData.map[ i ];
-         delete[] myData.map;
+            if( myData.map[ i ] != nullptr )
+               releaseBlock( myData.map[ i ] );
+         for( size_type i = 0; i < myData.numSpare; i++ )
+            releaseBlock( myData.spare[ i ] );
+         releaseSlab();
+         freeMap( myData.map, myData.mapSize );
+         if( myData.refs != nullptr )
+            freeRefs( myData.refs, myData.mapSize );
 
          myData.mapSize = 0;
          myData.mySize = 0;
          myData.myOff = 0;
+         myData.numSpare = 0;
          myData.map = nullptr;
+         myData.refs = nullptr;
       }
    }
 
+   // erase all, keeping the map and every block for reuse
+   void clear_keep_capacity()
+   {
+      dropShares();
+      if( !std::is_trivially_destructible< value_type >::value )
+         for( size_type off = myData.myOff; off < myData.myOff + myData.mySize; off++ )
+            if( myData.map[ getBlock( off ) ] != nullptr ) // null once left to a snapshot
+               destroy( &myData.map[ getBlock( off ) ][ off % compDequeSize() ] );
+
+      myData.myOff = 0;
+      myData.mySize = 0;
+   }
+
+   // report the memory the deque holds; O( mapSize ), without allocating
+   DequeMemoryStats memory_stats() const
+   {
+      size_type dequeSize = compDequeSize(); // elements per block (a power of 2)
+      DequeMemoryStats stats = DequeMemoryStats();
+      stats.mapSlots = myData.mapSize;
+      for( size_type i = 0; i < myData.mapSize; i++ )
+         if( myData.map[ i ] != nullptr )
+            stats.blocks++;
+      stats.nullSlots = myData.mapSize - stats.blocks;
+      stats.spareBlocks = myData.numSpare;
+      if( myData.mySize > 0 )
+      {
+         stats.liveBlocks = ( myData.myOff + myData.mySize - 1 ) / dequeSize - myData.myOff / dequeSize + 1;
+         if( stats.liveBlocks > myData.mapSize ) // first and last element share a block
+            stats.liveBlocks = myData.mapSize;
+         stats.frontSlack = myData.myOff % dequeSize;
+         stats.backSlack = ( dequeSize - ( myData.myOff + myData.mySize ) % dequeSize ) % dequeSize;
+      }
+
+      size_type slots = ( stats.blocks + stats.spareBlocks ) * dequeSize;
+      stats.mapBytes = myData.mapSize * sizeof( pointer );
+      stats.blockBytes = slots * sizeof( value_type );
+      stats.totalBytes = stats.mapBytes + stats.blockBytes;
+      stats.occupancy = slots == 0 ? 0 : static_cast< double >( myData.mySize ) / slots;
+      stats.growthEvents = myData.numGrowths;
+      return stats;
+   }
+
 private:
 
    // determine block from offset
@@ -449,13 +955,248 @@ private:
 //      return ( ( myData.off / compDequeSize() ) & ( myData.mapSize - 1 ) );
    }
 
-   size_type compDequeSize()
+   // construct an element from args in the raw slot p
+   template< typename... Args >
+   void construct( pointer p, Args &&...args )
+   {
+      BlockTraits::construct( myAlloc, p, std::forward< Args >( args )... );
+   }
+
+   // destroy the element in slot p, leaving the slot raw
+   void destroy( pointer p )
+   {
+      BlockTraits::destroy( myAlloc, p );
+   }
+
+   // allocate raw storage for one block; no element is constructed
+   pointer allocBlock()
+   {
+      return BlockTraits::allocate( myAlloc, compDequeSize() );
+   }
+
+   // release a block of raw storage whose elements are all destroyed;
+   // blocks carved from the slab go back with the slab, in clear
+   void releaseBlock( pointer block )
+   {
+      if( !inSlab( block ) )
+         BlockTraits::deallocate( myAlloc, block, compDequeSize() );
+   }
+
+   // return whether block was carved from the slab
+   bool inSlab( pointer block ) const
+   {
+      return std::less_equal< pointer >()( myData.slab, block ) &&
+             std::less< pointer >()( block, myData.slab + myData.slabBlocks * compDequeSize() );
+   }
+
+   // give up this deque's hold on the slab, releasing it if no snapshot still holds it
+   void releaseSlab()
+   {
+      if( myData.slab != nullptr )
+      {
+         // acq_rel: the last holder to let go sees every other holder's reads done
+         if( myData.slabRefs == nullptr || myData.slabRefs->fetch_sub( 1, std::memory_order_acq_rel ) == 1 )
+         {
+            BlockTraits::deallocate( myAlloc, myData.slab, myData.slabBlocks * compDequeSize() );
+            if( myData.slabRefs != nullptr )
+               freeRef( myData.slabRefs );
+         }
+         myData.slab = nullptr;
+         myData.slabBlocks = 0;
+         myData.slabRefs = nullptr;
+      }
+   }
+
+   // copy the elements at positions [ first, last ) of right to the same
+   // positions of the slab, a run contiguous in a block of right at a time
+   void copyRange( const deque &right, size_type first, size_type last )
+   {
+      size_type dequeSize = compDequeSize(); // elements per block (a power of 2)
+      while( first < last )
+      {
+         size_type src = right.myData.myOff + first;
+         size_type count = dequeSize - src % dequeSize;
+         if( count > last - first )
+            count = last - first;
+         copyRun( myData.slab + first, right.myData.map[ right.getBlock( src ) ] + src % dequeSize, count );
+         first += count;
+      }
+   }
+
+   // copy-construct count elements from src into the raw slots at dest; if a
+   // copy throws, the ones already built are destroyed before it propagates
+   void copyRun( pointer dest, const_pointer src, size_type count )
+   {
+      if constexpr( std::is_trivially_copyable< value_type >::value )
+         std::memcpy( dest, src, count * sizeof( value_type ) );
+      else
+      {
+         size_type i = 0;
+         try
+         {
+            for( ; i < count; i++ )
+               construct( dest + i, src[ i ] );
+         }
+         catch( ... )
+         {  // all or nothing: the caller counts whole runs
+            while( i > 0 )
+               destroy( dest + --i );
+            throw;
+         }
+      }
+   }
+
+   // allocate a map of count null block pointers
+   MapPtr allocMap( size_type count )
+   {
+      MapAlloc mapAlloc( myAlloc );
+      MapPtr map = MapTraits::allocate( mapAlloc, count );
+      for( size_type i = 0; i < count; i++ )
+         map[ i ] = nullptr;
+      return map;
+   }
+
+   // release a map of count block pointers
+   void freeMap( MapPtr map, size_type count )
+   {
+      MapAlloc mapAlloc( myAlloc );
+      MapTraits::deallocate( mapAlloc, map, count );
+   }
+
+   // move right's elements one by one to the same offsets in a map and blocks
+   // of this (empty) deque's own, then clear right. Each element is counted
+   // as soon as it is built, so a throw leaves this deque valid
+   void moveElements( deque &right )
+   {
+      size_type dequeSize = compDequeSize(); // elements per block (a power of 2)
+      right.unshareAll(); // a snapshot's elements must not be moved from
+      if( right.myData.mySize > 0 )
+      {
+         myData.map = allocMap( right.myData.mapSize );
+         myData.mapSize = right.myData.mapSize;
+         myData.myOff = right.myData.myOff;
+         ++myData.numGrowths;
+         for( size_type off = myData.myOff; off < myData.myOff + right.myData.mySize; off++ )
+         {
+            MapPtr block = myData.map + getBlock( off );
+            if( *block == nullptr )
+               *block = allocBlock();
+            construct( &( *block )[ off % dequeSize ],
+                       std::move( right.myData.map[ right.getBlock( off ) ][ off % dequeSize ] ) );
+            ++myData.mySize;
+         }
+      }
+      right.clear();
+   }
+
+   // allocate count null share counts, one per map slot
+   RefCount **allocRefs( size_type count )
+   {
+      RefMapAlloc refMapAlloc( myAlloc );
+      RefCount **refs = RefMapTraits::allocate( refMapAlloc, count );
+      for( size_type i = 0; i < count; i++ )
+         refs[ i ] = nullptr;
+      return refs;
+   }
+
+   // allocate a share count for a block or slab held by this deque alone
+   RefCount *allocRef()
+   {
+      RefAlloc refAlloc( myAlloc );
+      RefCount *ref = RefTraits::allocate( refAlloc, 1 );
+      RefTraits::construct( refAlloc, ref, size_type( 1 ) );
+      return ref;
+   }
+
+   // release a share count no deque holds any more
+   void freeRef( RefCount *ref )
+   {
+      RefAlloc refAlloc( myAlloc );
+      RefTraits::destroy( refAlloc, ref );
+      RefTraits::deallocate( refAlloc, ref, 1 );
+   }
+
+   // release an array of count share counts
+   void freeRefs( RefCount **refs, size_type count )
+   {
+      RefMapAlloc refMapAlloc( myAlloc );
+      RefMapTraits::deallocate( refMapAlloc, refs, count );
+   }
+
+   // give up this deque's share of the block in map slot slot; the last
+   // deque holding it keeps it as its own. Return whether this was the last
+   bool leaveShare( size_type slot )
+   {
+      // acq_rel: the last holder to let go sees every other holder's reads done
+      bool last = myData.refs[ slot ]->fetch_sub( 1, std::memory_order_acq_rel ) == 1;
+      if( last )
+         freeRef( myData.refs[ slot ] );
+      else
+         myData.map[ slot ] = nullptr;
+      myData.refs[ slot ] = nullptr;
+      return last;
+   }
+
+   // leave every shared block to the deques still holding it
+   void dropShares()
+   {
+      if( myData.refs != nullptr )
+         for( size_type i = 0; i < myData.mapSize; i++ )
+            if( myData.refs[ i ] != nullptr )
+               leaveShare( i );
+   }
+
+   // make the block in map slot slot this deque's own, copying its elements
+   // into a fresh block if another deque still shares it
+   void unshareBlock( size_type slot )
+   {
+      if( myData.refs[ slot ]->load( std::memory_order_acquire ) == 1 )
+      {
+         leaveShare( slot );
+         return;
+      }
+
+      size_type dequeSize = compDequeSize(); // elements per block (a power of 2)
+      size_type capacity = myData.mapSize * dequeSize;
+      pointer shared = myData.map[ slot ];
+      pointer block = allocBlock();
+      for( size_type col = 0; col < dequeSize; col++ )
+         if( ( slot * dequeSize + col + capacity - myData.myOff % capacity ) % capacity < myData.mySize )
+            construct( &block[ col ], shared[ col ] );
+
+      if( leaveShare( slot ) ) // the other holders let go meanwhile: the old block is left to this deque
+      {
+         if( !std::is_trivially_destructible< value_type >::value )
+            for( size_type col = 0; col < dequeSize; col++ )
+               if( ( slot * dequeSize + col + capacity - myData.myOff % capacity ) % capacity < myData.mySize )
+                  destroy( &shared[ col ] );
+         releaseBlock( shared );
+      }
+      myData.map[ slot ] = block;
+   }
+
+   // make every shared block this deque's own; the share counts go with them,
+   // so mutable access costs nothing more until the next snapshot
+   void unshareAll()
+   {
+      if( myData.refs != nullptr )
+      {
+         for( size_type i = 0; i < myData.mapSize; i++ )
+            if( myData.refs[ i ] != nullptr )
+               unshareBlock( i );
+         freeRefs( myData.refs, myData.mapSize );
+         myData.refs = nullptr;
+      }
+   }
+
+   // elements per block (a power of 2)
+   static constexpr size_type compDequeSize()
    {
-      return sizeof( value_type ) <= 1 ? 16 : sizeof( value_type ) <= 2 ? 8 :
-             sizeof( value_type ) <= 4 ?  4 : sizeof( value_type ) <= 8 ? 2 : 1;
+      return ScaryVal::dequeSize;
    }
 
    ScaryVal myData;
+   BlockAlloc myAlloc; // allocates blocks and elements; rebound for the map
 };
 
 #endif
\ No newline at end of file
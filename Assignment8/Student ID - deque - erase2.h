@@ -1,6 +1,49 @@
 #ifndef DEQUE_H
 #define DEQUE_H
 
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+// CLASS TEMPLATE DequeBlockBytes
+// block geometry policy: each block spans Bytes bytes, rounded down to
+// a power of 2 elements (at least one element per block)
+template< size_t Bytes >
+struct DequeBlockBytes
+{
+   template< typename Ty >
+   static constexpr size_t elements()
+   {
+      return floorPow2( Bytes / sizeof( Ty ) );
+   }
+
+private:
+   static constexpr size_t floorPow2( size_t n )
+   {
+      return n <= 1 ? 1 : 2 * floorPow2( n / 2 );
+   }
+};
+
+// CLASS TEMPLATE DequeBlockElements
+// block geometry policy: each block holds Count elements
+template< size_t Count >
+struct DequeBlockElements
+{
+   static_assert( Count > 0 && ( Count & ( Count - 1 ) ) == 0,
+                  "elements per block must be a power of 2" );
+
+   template< typename Ty >
+   static constexpr size_t elements()
+   {
+      return Count;
+   }
+};
+
+// 16 bytes per block: 16, 8, 4, 2 or 1 elements for 1, 2, 4, 8 or >8 byte types
+using DequeDefaultBlock = DequeBlockBytes< 16 >;
+
 // CLASS TEMPLATE DequeConstIterator
 template< typename MyDeque >
 class DequeConstIterator // iterator for nonmutable deque
@@ -9,6 +52,7 @@ private:
    using size_type = typename MyDeque::size_type;
 
 public:
+   using iterator_category = std::random_access_iterator_tag;
    using value_type = typename MyDeque::value_type;
    using difference_type = typename MyDeque::difference_type;
    using pointer = typename MyDeque::const_pointer;
@@ -16,21 +60,28 @@ public:
 
    // construct with null pointer
    DequeConstIterator()
-      : myOff( 0 ),
-      myCont( nullptr )
+      : myCont( nullptr ),
+        myOff( 0 ),
+        myCur( nullptr ),
+        myFirst( nullptr ),
+        myLast( nullptr )
    {
    }
 
    // construct with offset off in *pDeque
    DequeConstIterator( size_type off, const MyDeque *pDeque )
-      : myOff( off ),
-      myCont( pDeque )
+      : myCont( pDeque ),
+        myOff( off )
    {
+      setBlock();
    }
 
    DequeConstIterator( const DequeConstIterator &right ) // copy constructor
-      : myOff( right.myOff ),
-      myCont( right.myCont )
+      : myCont( right.myCont ),
+        myOff( right.myOff ),
+        myCur( right.myCur ),
+        myFirst( right.myFirst ),
+        myLast( right.myLast )
    {
    }
 
@@ -45,32 +96,28 @@ public:
       {
          myCont = right.myCont;
          myOff = right.myOff;
+         myCur = right.myCur;
+         myFirst = right.myFirst;
+         myLast = right.myLast;
       }
       return *this; // enables x = y = z, for example
    }
 
    reference operator*() const
    {
-      // elements per block (a power of 2)
-      size_type dequeSize = sizeof( value_type ) <= 1 ? 16 :
-                            sizeof( value_type ) <= 2 ?  8 :
-                            sizeof( value_type ) <= 4 ?  4 :
-                            sizeof( value_type ) <= 8 ?  2 : 1;
-
-//      size_type block = myOff % ( dequeSize * myCont->mapSize ) / dequeSize;
-      size_type block = myCont->getBlock( myOff );
-      size_type off = myOff % dequeSize;
-      return myCont->map[ block ][ off ];
+      return *myCur;
    }
 
    pointer operator->() const
    {
-      return &( operator*() );
+      return myCur;
    }
 
    DequeConstIterator& operator++() // preincrement
    {
       ++myOff;
+      if( ++myCur == myLast ) // stepped off the end of the block
+         setBlock();
       return *this;
    }
 
@@ -84,6 +131,10 @@ public:
    DequeConstIterator& operator--() // predecrement
    {
       --myOff;
+      if( myCur == myFirst ) // step back into the previous block
+         setBlock();
+      else
+         --myCur;
       return *this;
    }
 
@@ -98,6 +149,11 @@ public:
    DequeConstIterator& operator+=( const difference_type off )
    {
       myOff += off;
+      difference_type col = ( myCur - myFirst ) + off;
+      if( myFirst != nullptr && col >= 0 && col < static_cast< difference_type >( MyDeque::dequeSize ) )
+         myCur += off; // still inside the cached block
+      else
+         setBlock();
       return *this;
    }
 
@@ -170,6 +226,26 @@ public:
 
    const MyDeque *myCont; // keep a pointer to deque
    size_type myOff;       // offset of element in deque
+
+private:
+   // cache the bounds of the block holding myOff, so that dereferencing and
+   // stepping inside a block never touch the map
+   void setBlock()
+   {
+      if( myCont != nullptr && myCont->map != nullptr &&
+          myCont->map[ myCont->getBlock( myOff ) ] != nullptr )
+      {
+         myFirst = myCont->map[ myCont->getBlock( myOff ) ];
+         myLast = myFirst + MyDeque::dequeSize;
+         myCur = myFirst + myOff % MyDeque::dequeSize;
+      }
+      else // no block allocated there yet, e.g. end() on a block boundary
+         myCur = myFirst = myLast = nullptr;
+   }
+
+   pointer myCur;   // current element
+   pointer myFirst; // beginning of the block holding the current element
+   pointer myLast;  // end of the block holding the current element
 };
 
 
@@ -271,8 +347,25 @@ public:
    }
 };
 
+// memory held by a deque, as reported by deque::memory_stats()
+struct DequeMemoryStats
+{
+   size_t mapBytes;     // bytes in the map
+   size_t blockBytes;   // bytes in allocated blocks, spare blocks included
+   size_t totalBytes;   // mapBytes + blockBytes
+   size_t mapSlots;     // slots in the map
+   size_t nullSlots;    // map slots without a block
+   size_t blocks;       // blocks in the map
+   size_t liveBlocks;   // blocks holding at least one element
+   size_t spareBlocks;  // blocks on the spare list
+   size_t frontSlack;   // raw slots in the first live block, before the first element
+   size_t backSlack;    // raw slots in the last live block, after the last element
+   double occupancy;    // elements per slot in allocated blocks; 0 without blocks
+   size_t growthEvents; // times the map was allocated or grown
+};
+
 // CLASS TEMPLATE DequeVal
-template< typename Ty >
+template< typename Ty, typename BlockPolicy = DequeDefaultBlock >
 class DequeVal // base class for deque to hold data
 {
 public:
@@ -285,41 +378,54 @@ public:
    using const_reference = const value_type &;
    using MapPtr = Ty **;
 
+   // elements per block (a power of 2)
+   static constexpr size_type dequeSize = BlockPolicy::template elements< Ty >();
+
+   // most blocks kept on the spare list; freed blocks beyond it go back to the heap
+   static constexpr size_type maxSpare = 8;
+
    DequeVal() // initialize values
       : map(),
       mapSize( 0 ),
       myOff( 0 ),
-      mySize( 0 )
+      mySize( 0 ),
+      spare(),
+      numSpare( 0 ),
+      trimPercent( 0 ),
+      numGrowths( 0 )
    {
    }
 
    // determine block from offset
    size_type getBlock( size_type off ) const
    {
-      // elements per block (a power of 2)
-      size_type dequeSize = sizeof( value_type ) <= 1 ? 16 :
-                            sizeof( value_type ) <= 2 ?  8 :
-                            sizeof( value_type ) <= 4 ?  4 :
-                            sizeof( value_type ) <= 8 ?  2 : 1;
-
-      return off % ( dequeSize * mapSize ) / dequeSize;
-//      return ( off / dequeSize ) & ( mapSize - 1 );
+      return ( off / dequeSize ) & ( mapSize - 1 ); // mapSize is zero or 2^N
+//      return off % ( dequeSize * mapSize ) / dequeSize;
    }
 
    MapPtr map;        // pointer to array of pointers to blocks
    size_type mapSize; // size of map array, zero or 2^N
    size_type myOff;   // offset of initial element
    size_type mySize;  // current length of sequence
+
+   pointer spare[ maxSpare ]; // vacated blocks, kept for reuse
+   size_type numSpare;        // number of blocks on the spare list
+   size_type trimPercent;     // occupancy (in percent) below which the map is halved; 0 = never
+   size_type numGrowths;      // times the map was allocated or grown
 };
 
 
 // CLASS TEMPLATE deque
-template< typename Ty >
+template< typename Ty, typename BlockPolicy = DequeDefaultBlock, typename Alloc = std::allocator< Ty > >
 class deque // circular queue of pointers to blocks
 {
 private:
    using MapPtr = Ty **;
-   using ScaryVal = DequeVal< Ty >;
+   using ScaryVal = DequeVal< Ty, BlockPolicy >;
+   using BlockAlloc = typename std::allocator_traits< Alloc >::template rebind_alloc< Ty >;
+   using BlockTraits = std::allocator_traits< BlockAlloc >;
+   using MapAlloc = typename BlockTraits::template rebind_alloc< Ty * >;
+   using MapTraits = std::allocator_traits< MapAlloc >;
 
 public:
    using value_type = Ty;
@@ -329,14 +435,32 @@ public:
    using const_pointer = const value_type *;
    using reference = value_type &;
    using const_reference = const value_type &;
+   using allocator_type = Alloc;
 
    using iterator = DequeIterator< ScaryVal >;
    using const_iterator = DequeConstIterator< ScaryVal >;
 
    // construct empty deque
    deque()
-      : myData()
+      : myData(),
+        myAlloc()
+   {
+   }
+
+   // construct empty deque with allocator
+   explicit deque( const Alloc &al )
+      : myData(),
+        myAlloc( al )
+   {
+   }
+
+   // construct by moving right: its map and blocks change hands in O(1),
+   // leaving right empty
+   deque( deque &&right ) noexcept
+      : myData( right.myData ),
+        myAlloc( std::move( right.myAlloc ) )
    {
+      right.myData = ScaryVal();
    }
 
    // destroy the deque
@@ -345,6 +469,36 @@ public:
       clear();
    }
 
+   // return allocator object for values
+   allocator_type get_allocator() const
+   {
+      return allocator_type( myAlloc );
+   }
+
+   // move right into this deque; with an allocator that propagates or compares
+   // equal, the map and blocks change hands in O(1), otherwise the elements are
+   // moved one by one into blocks of this deque's own. right is left empty
+   deque& operator=( deque &&right ) noexcept( BlockTraits::propagate_on_container_move_assignment::value ||
+                                               BlockTraits::is_always_equal::value )
+   {
+      if( &right != this )
+      {
+         clear();
+         if constexpr( BlockTraits::propagate_on_container_move_assignment::value )
+            myAlloc = std::move( right.myAlloc );
+
+         if( BlockTraits::propagate_on_container_move_assignment::value || myAlloc == right.myAlloc )
+         {
+            myData = right.myData;
+            right.myData = ScaryVal();
+         }
+         else
+            moveElements( right );
+      }
+
+      return *this;
+   }
+
    // return iterator for beginning of mutable sequence
    iterator begin()
    {
@@ -388,106 +542,96 @@ public:
 
    const_reference operator[]( size_type pos ) const
    {
-      return *( begin() + static_cast< difference_type >( pos ) );
+      size_type off = myData.myOff + pos;
+      return myData.map[ getBlock( off ) ][ off % compDequeSize() ];
    }
 
    reference operator[]( size_type pos )
    {
-      return *( begin() + static_cast< difference_type >( pos ) );
+      size_type off = myData.myOff + pos;
+      return myData.map[ getBlock( off ) ][ off % compDequeSize() ];
    }
 
-   // erase element at where
+   // erase element at where, moving the shorter side over it a block run at a time
    iterator erase( const_iterator where )
    {
-      if( myData.mySize == 1 && begin() == where )
+      return erase( where, where + 1 );
+   }
+
+   // erase [ first, last )
+   iterator erase( const_iterator first, const_iterator last )
+   {
+      size_type off = static_cast< size_type >( first - begin() );
+      size_type count = static_cast< size_type >( last - first );
+      if( count == 0 )
+         return begin() + static_cast< difference_type >( off );
+
+      size_type oldFirst = myData.myOff;
+      size_type oldEnd = myData.myOff + myData.mySize;
+      if( !std::is_trivially_destructible< value_type >::value )
+         for( size_type i = 0; i < count; i++ )
+            destroy( &element( myData.myOff + off + i ) );
+
+      if( off < myData.mySize - off - count ) // fewer elements in front: move them backward
       {
+         shiftElements( myData.myOff + count, myData.myOff, off );
+         myData.myOff += count;
+      }
+      else // move the elements behind the gap forward
+         shiftElements( myData.myOff + off, myData.myOff + off + count, myData.mySize - off - count );
+      myData.mySize -= count;
+
+      // release the blocks no element lives in any more; in a full map the
+      // first and last elements can share one block, which must survive
+      size_type dequeSize = compDequeSize(); // elements per block (a power of 2)
+      size_type firstBlock = oldFirst / dequeSize;
+      size_type endBlock = ( oldEnd - 1 ) / dequeSize + 1;
+      bool shared = endBlock - firstBlock > myData.mapSize;
+      if( myData.mySize == 0 )
+      {
+         freeBlocks( firstBlock, shared ? endBlock - 1 : endBlock );
          myData.myOff = 0;
-         myData.mySize = 0;
-         return begin();
       }
+      else if( myData.myOff != oldFirst )
+         freeBlocks( shared ? firstBlock + 1 : firstBlock, myData.myOff / dequeSize );
       else
-      {
-         iterator whereIt = makeIter( where );
-         size_type off = static_cast< size_type >( where - begin() );
+         freeBlocks( ( oldEnd - count + dequeSize - 1 ) / dequeSize, shared ? endBlock - 1 : endBlock );
+      autoTrim();
 
-         size_t dequeSize = compDequeSize();
-         if( off < myData.mySize / 2 ) // closer to front
-         {
-             size_t row = ((myData.myOff + off) / dequeSize) % myData.mapSize;
-             size_t col = ((myData.myOff + off) % dequeSize);
-             size_t nextRow = 0, nextCol = 0;
-             if (row == 0 && col == 0) {
-                 nextRow = myData.mapSize - 1;
-                 nextCol = dequeSize - 1;
-             }
-             else if (col == 0) {
-                 nextRow = row - 1;
-                 nextCol = dequeSize - 1;
-             }
-             else {
-                 nextRow = row;
-                 nextCol = col - 1;
-             }
-             for (size_t i = 0; i < off; i++) {
-                 myData.map[row][col] = myData.map[nextRow][nextCol];
-                 row = nextRow;
-                 col = nextCol;
-                 if (row == 0 && col == 0) {
-                     nextRow = myData.mapSize - 1;
-                     nextCol = dequeSize - 1;
-                 }
-                 else if (col == 0) {
-                     nextRow = row - 1;
-                     nextCol = dequeSize - 1;
-                 }
-                 else {
-                     nextCol = col - 1;
-                 }
-             }
-             myData.myOff++;
-
-
-         }
-         else // closer to back
-         {
-             size_t row = ((myData.myOff + off) / dequeSize) % myData.mapSize;
-             size_t col = ((myData.myOff + off) % dequeSize);
-             size_t nextRow = 0, nextCol = 0;
-             if (row == myData.mapSize - 1 && col == dequeSize - 1) {
-                 nextRow = 0;
-                 nextCol = 0;
-             }
-             else if (col == dequeSize - 1) {
-                 nextRow = row + 1;
-                 nextCol = 0;
-             }
-             else {
-                 nextRow = row;
-                 nextCol = col + 1;
-             }
-             for (size_t i = 0; i < myData.mySize - off - 1; i++) {
-                 myData.map[row][col] = myData.map[nextRow][nextCol];
-                 row = nextRow;
-                 col = nextCol;
-                 if (row == myData.mapSize - 1 && col == dequeSize - 1) {
-                     nextRow = 0;
-                     nextCol = 0;
-                 }
-                 else if (col == dequeSize - 1) {
-                     nextRow = row + 1;
-                     nextCol = 0;
-                 }
-                 else {
-                     nextCol = col + 1;
-                 }
-             }
-
-
-         }
+      return begin() + static_cast< difference_type >( off );
+   }
 
-         --myData.mySize;
+   // call func( p, count ) for each run of elements stored contiguously
+   // in one block, in sequence order
+   template< typename Func >
+   void for_each_segment( Func func )
+   {
+      size_type dequeSize = compDequeSize(); // elements per block (a power of 2)
+      size_type off = myData.myOff;
+      for( size_type left = myData.mySize; left > 0; )
+      {
+         size_type col = off % dequeSize;
+         size_type count = dequeSize - col < left ? dequeSize - col : left;
+         func( static_cast< pointer >( myData.map[ getBlock( off ) ] + col ), count );
+         off += count;
+         left -= count;
+      }
+   }
 
-         return begin() + static_cast< difference_type >( off );
+   // call func( p, count ) for each run of elements stored contiguously
+   // in one block, in sequence order
+   template< typename Func >
+   void for_each_segment( Func func ) const
+   {
+      size_type dequeSize = compDequeSize(); // elements per block (a power of 2)
+      size_type off = myData.myOff;
+      for( size_type left = myData.mySize; left > 0; )
+      {
+         size_type col = off % dequeSize;
+         size_type count = dequeSize - col < left ? dequeSize - col : left;
+         func( static_cast< const_pointer >( myData.map[ getBlock( off ) ] + col ), count );
+         off += count;
+         left -= count;
       }
    }
 
@@ -496,18 +640,86 @@ public:
    {
       if( myData.mapSize > 0 )
       {
+         if( !std::is_trivially_destructible< value_type >::value )
+            for( size_type off = myData.myOff; off < myData.myOff + myData.mySize; off++ )
+               destroy( &element( off ) );
+
          for( size_type i = 0; i < myData.mapSize; i++ )
             if( myData.map[ i ] != nullptr )
-               delete[] myData.map[ i ];
-         delete[] myData.map;
+               releaseBlock( myData.map[ i ] );
+         for( size_type i = 0; i < myData.numSpare; i++ )
+            releaseBlock( myData.spare[ i ] );
+         freeMap( myData.map, myData.mapSize );
 
          myData.mapSize = 0;
          myData.mySize = 0;
          myData.myOff = 0;
+         myData.numSpare = 0;
          myData.map = nullptr;
       }
    }
 
+   // erase all, keeping the map and every block for reuse
+   void clear_keep_capacity()
+   {
+      if( !std::is_trivially_destructible< value_type >::value )
+         for( size_type off = myData.myOff; off < myData.myOff + myData.mySize; off++ )
+            destroy( &element( off ) );
+
+      myData.myOff = 0;
+      myData.mySize = 0;
+   }
+
+   // report the memory the deque holds; O( mapSize ), without allocating
+   DequeMemoryStats memory_stats() const
+   {
+      size_type dequeSize = compDequeSize(); // elements per block (a power of 2)
+      DequeMemoryStats stats = DequeMemoryStats();
+      stats.mapSlots = myData.mapSize;
+      for( size_type i = 0; i < myData.mapSize; i++ )
+         if( myData.map[ i ] != nullptr )
+            stats.blocks++;
+      stats.nullSlots = myData.mapSize - stats.blocks;
+      stats.spareBlocks = myData.numSpare;
+      if( myData.mySize > 0 )
+      {
+         stats.liveBlocks = ( myData.myOff + myData.mySize - 1 ) / dequeSize - myData.myOff / dequeSize + 1;
+         if( stats.liveBlocks > myData.mapSize ) // first and last element share a block
+            stats.liveBlocks = myData.mapSize;
+         stats.frontSlack = myData.myOff % dequeSize;
+         stats.backSlack = ( dequeSize - ( myData.myOff + myData.mySize ) % dequeSize ) % dequeSize;
+      }
+
+      size_type slots = ( stats.blocks + stats.spareBlocks ) * dequeSize;
+      stats.mapBytes = myData.mapSize * sizeof( pointer );
+      stats.blockBytes = slots * sizeof( value_type );
+      stats.totalBytes = stats.mapBytes + stats.blockBytes;
+      stats.occupancy = slots == 0 ? 0 : static_cast< double >( myData.mySize ) / slots;
+      stats.growthEvents = myData.numGrowths;
+      return stats;
+   }
+
+   // release the spare blocks and every block no element lives in, and shrink
+   // the map to the smallest size the elements need; no element is moved
+   void shrink_to_fit()
+   {
+      if( myData.mySize == 0 )
+         clear();
+      else
+      {
+         size_type newMapSize = fitMapSize();
+         shrinkMap( newMapSize < myData.mapSize ? newMapSize : myData.mapSize );
+      }
+   }
+
+   // once fewer than percent of the slots in the map hold elements, release the
+   // unused blocks and halve the map; 0 (the default) turns trimming off.
+   // A percent below 50 leaves a halved map room before it has to grow again
+   void set_auto_trim( size_type percent )
+   {
+      myData.trimPercent = percent;
+   }
+
 private:
 
    // determine block from offset
@@ -517,13 +729,220 @@ private:
 //      return ( ( myData.off / compDequeSize() ) & ( myData.mapSize - 1 ) );
    }
 
-   size_type compDequeSize()
+   // return element at offset off
+   reference element( size_type off )
+   {
+      return myData.map[ getBlock( off ) ][ off % compDequeSize() ];
+   }
+
+   // move count elements from offset src into the raw slots at offset dest,
+   // which may overlap; whole runs inside one block at a time, with memmove
+   // when Ty allows it; the slots left behind are raw
+   void shiftElements( size_type dest, size_type src, size_type count )
+   {
+      size_type dequeSize = compDequeSize(); // elements per block (a power of 2)
+      if( dest < src ) // moving forward: copy runs from the front
+         while( count > 0 )
+         {
+            size_type run = count;
+            if( run > dequeSize - src % dequeSize )
+               run = dequeSize - src % dequeSize;
+            if( run > dequeSize - dest % dequeSize )
+               run = dequeSize - dest % dequeSize;
+            moveRun( &element( dest ), &element( src ), run );
+            dest += run;
+            src += run;
+            count -= run;
+         }
+      else if( dest > src ) // moving backward: copy runs from the back
+         while( count > 0 )
+         {
+            size_type run = count;
+            if( run > ( src + count - 1 ) % dequeSize + 1 )
+               run = ( src + count - 1 ) % dequeSize + 1;
+            if( run > ( dest + count - 1 ) % dequeSize + 1 )
+               run = ( dest + count - 1 ) % dequeSize + 1;
+            count -= run;
+            moveRun( &element( dest + count ), &element( src + count ), run );
+         }
+   }
+
+   // move count contiguous elements from src into the raw slots at dest,
+   // which may overlap; each source element is destroyed once moved
+   void moveRun( pointer dest, pointer src, size_type count )
+   {
+      if( std::is_trivially_copyable< value_type >::value )
+         std::memmove( static_cast< void * >( dest ), src, count * sizeof( value_type ) );
+      else if( dest < src )
+         for( size_type i = 0; i < count; i++ )
+         {
+            construct( dest + i, std::move( src[ i ] ) );
+            destroy( src + i );
+         }
+      else
+         for( size_type i = count; i > 0; i-- )
+         {
+            construct( dest + i - 1, std::move( src[ i - 1 ] ) );
+            destroy( src + i - 1 );
+         }
+   }
+
+   // construct an element from args in the raw slot p
+   template< typename... Args >
+   void construct( pointer p, Args &&...args )
+   {
+      BlockTraits::construct( myAlloc, p, std::forward< Args >( args )... );
+   }
+
+   // destroy the element in slot p, leaving the slot raw
+   void destroy( pointer p )
+   {
+      BlockTraits::destroy( myAlloc, p );
+   }
+
+   // take a block from the spare list, or allocate raw storage for one;
+   // no element is constructed
+   pointer allocBlock()
+   {
+      if( myData.numSpare > 0 )
+         return myData.spare[ --myData.numSpare ];
+
+      return BlockTraits::allocate( myAlloc, compDequeSize() );
+   }
+
+   // put a block whose elements are all destroyed on the spare list,
+   // or release it once the list is full
+   void freeBlock( pointer block )
+   {
+      if( myData.numSpare < ScaryVal::maxSpare )
+         myData.spare[ myData.numSpare++ ] = block;
+      else
+         releaseBlock( block );
+   }
+
+   // release a block of raw storage whose elements are all destroyed
+   void releaseBlock( pointer block )
+   {
+      BlockTraits::deallocate( myAlloc, block, compDequeSize() );
+   }
+
+   // allocate a map of count null block pointers
+   MapPtr allocMap( size_type count )
+   {
+      MapAlloc mapAlloc( myAlloc );
+      MapPtr map = MapTraits::allocate( mapAlloc, count );
+      for( size_type i = 0; i < count; i++ )
+         map[ i ] = nullptr;
+      return map;
+   }
+
+   // release a map of count block pointers
+   void freeMap( MapPtr map, size_type count )
+   {
+      MapAlloc mapAlloc( myAlloc );
+      MapTraits::deallocate( mapAlloc, map, count );
+   }
+
+   // delete the blocks holding offsets [ first * dequeSize, last * dequeSize )
+   void freeBlocks( size_type first, size_type last )
+   {
+      for( size_type block = first; block < last; block++ )
+      {
+         freeBlock( myData.map[ block & ( myData.mapSize - 1 ) ] );
+         myData.map[ block & ( myData.mapSize - 1 ) ] = nullptr;
+      }
+   }
+
+   // smallest map (a power of 2, at least 8) the elements fit in with the
+   // slot to spare that the growth rule keeps
+   size_type fitMapSize() const
+   {
+      size_type newMapSize = 8;
+      while( newMapSize <= ( myData.mySize + compDequeSize() ) / compDequeSize() )
+         newMapSize *= 2;
+      return newMapSize;
+   }
+
+   // move to a map of newMapSize slots (a power of 2, at least fitMapSize()) by
+   // relinking the blocks in use; every other block, spares included, is released
+   void shrinkMap( size_type newMapSize )
+   {
+      size_type dequeSize = compDequeSize(); // elements per block (a power of 2)
+      size_type oldMapSize = myData.mapSize;
+      MapPtr newMap = allocMap( newMapSize );
+
+      // in a full map the first and last blocks can be one; relink before clearing
+      size_type first = myData.myOff / dequeSize; // first block in use
+      size_type numBlocks = myData.mySize == 0 ? 0 :
+                            ( myData.myOff + myData.mySize - 1 ) / dequeSize - first + 1;
+      for( size_type block = first; block < first + numBlocks; block++ )
+         newMap[ block & ( newMapSize - 1 ) ] = myData.map[ block & ( oldMapSize - 1 ) ];
+      for( size_type block = first; block < first + numBlocks; block++ )
+         myData.map[ block & ( oldMapSize - 1 ) ] = nullptr;
+
+      for( size_type i = 0; i < oldMapSize; i++ )
+         if( myData.map[ i ] != nullptr )
+            releaseBlock( myData.map[ i ] );
+      for( size_type i = 0; i < myData.numSpare; i++ )
+         releaseBlock( myData.spare[ i ] );
+      myData.numSpare = 0;
+
+      freeMap( myData.map, oldMapSize );
+      myData.map = newMap;
+      myData.mapSize = newMapSize;
+      myData.myOff &= newMapSize * dequeSize - 1;
+   }
+
+   // with auto trim on, halve the map while occupancy is below trimPercent,
+   // relinking the blocks once for the final size
+   void autoTrim()
+   {
+      if( myData.trimPercent > 0 && myData.mapSize > 8 &&
+          myData.mySize * 100 < myData.trimPercent * myData.mapSize * compDequeSize() )
+      {
+         size_type fit = fitMapSize();
+         size_type newMapSize = myData.mapSize;
+         while( newMapSize / 2 >= fit &&
+                myData.mySize * 100 < myData.trimPercent * newMapSize * compDequeSize() )
+            newMapSize /= 2;
+         if( newMapSize < myData.mapSize )
+            shrinkMap( newMapSize );
+      }
+   }
+
+   // move right's elements one by one to the same offsets in a map and blocks
+   // of this (empty) deque's own, then clear right. Each element is counted
+   // as soon as it is built, so a throw leaves this deque valid
+   void moveElements( deque &right )
+   {
+      size_type dequeSize = compDequeSize(); // elements per block (a power of 2)
+      if( right.myData.mySize > 0 )
+      {
+         myData.map = allocMap( right.myData.mapSize );
+         myData.mapSize = right.myData.mapSize;
+         myData.myOff = right.myData.myOff;
+         ++myData.numGrowths;
+         for( size_type off = myData.myOff; off < myData.myOff + right.myData.mySize; off++ )
+         {
+            MapPtr block = myData.map + getBlock( off );
+            if( *block == nullptr )
+               *block = allocBlock();
+            construct( &( *block )[ off % dequeSize ],
+                       std::move( right.myData.map[ right.getBlock( off ) ][ off % dequeSize ] ) );
+            ++myData.mySize;
+         }
+      }
+      right.clear();
+   }
+
+   // elements per block (a power of 2)
+   static constexpr size_type compDequeSize()
    {
-      return sizeof( value_type ) <= 1 ? 16 : sizeof( value_type ) <= 2 ? 8 :
-            sizeof( value_type ) <= 4 ? 4 : sizeof( value_type ) <= 8 ? 2 : 1;
+      return ScaryVal::dequeSize;
    }
 
    ScaryVal myData;
+   BlockAlloc myAlloc; // allocates blocks and elements; rebound for the map
 };
 
 #endif
\ No newline at end of file
@@ -1,6 +1,57 @@
 #ifndef DEQUE_H
 #define DEQUE_H
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// CLASS TEMPLATE DequeBlockBytes
+// block geometry policy: each block spans Bytes bytes, rounded down to
+// a power of 2 elements (at least one element per block)
+template< size_t Bytes >
+struct DequeBlockBytes
+{
+   template< typename Ty >
+   static constexpr size_t elements()
+   {
+      return floorPow2( Bytes / sizeof( Ty ) );
+   }
+
+private:
+   static constexpr size_t floorPow2( size_t n )
+   {
+      return n <= 1 ? 1 : 2 * floorPow2( n / 2 );
+   }
+};
+
+// CLASS TEMPLATE DequeBlockElements
+// block geometry policy: each block holds Count elements
+template< size_t Count >
+struct DequeBlockElements
+{
+   static_assert( Count > 0 && ( Count & ( Count - 1 ) ) == 0,
+                  "elements per block must be a power of 2" );
+
+   template< typename Ty >
+   static constexpr size_t elements()
+   {
+      return Count;
+   }
+};
+
+// 16 bytes per block: 16, 8, 4, 2 or 1 elements for 1, 2, 4, 8 or >8 byte types
+using DequeDefaultBlock = DequeBlockBytes< 16 >;
+
 // CLASS TEMPLATE DequeConstIterator
 template< typename MyDeque >
 class DequeConstIterator // iterator for nonmutable deque
@@ -9,6 +60,7 @@ private:
    using size_type = typename MyDeque::size_type;
 
 public:
+   using iterator_category = std::random_access_iterator_tag;
    using value_type = typename MyDeque::value_type;
    using difference_type = typename MyDeque::difference_type;
    using pointer = typename MyDeque::const_pointer;
@@ -16,21 +68,28 @@ public:
 
    // construct with null pointer
    DequeConstIterator()
-      : myOff( 0 ),
-      myCont( nullptr )
+      : myCont( nullptr ),
+        myOff( 0 ),
+        myCur( nullptr ),
+        myFirst( nullptr ),
+        myLast( nullptr )
    {
    }
 
    // construct with offset off in *pDeque
    DequeConstIterator( size_type off, const MyDeque *pDeque )
-      : myOff( off ),
-      myCont( pDeque )
+      : myCont( pDeque ),
+        myOff( off )
    {
+      setBlock();
    }
 
    DequeConstIterator( const DequeConstIterator &right ) // copy constructor
-      : myOff( right.myOff ),
-      myCont( right.myCont )
+      : myCont( right.myCont ),
+        myOff( right.myOff ),
+        myCur( right.myCur ),
+        myFirst( right.myFirst ),
+        myLast( right.myLast )
    {
    }
 
@@ -45,32 +104,28 @@ public:
       {
          myCont = right.myCont;
          myOff = right.myOff;
+         myCur = right.myCur;
+         myFirst = right.myFirst;
+         myLast = right.myLast;
       }
       return *this; // enables x = y = z, for example
    }
 
    reference operator*() const
    {
-      // elements per block (a power of 2)
-      size_type dequeSize = sizeof( value_type ) <= 1 ? 16 :
-                            sizeof( value_type ) <= 2 ?  8 :
-                            sizeof( value_type ) <= 4 ?  4 :
-                            sizeof( value_type ) <= 8 ?  2 : 1;
-
-//      size_type block = myOff % ( dequeSize * myCont->mapSize ) / dequeSize;
-      size_type block = myCont->getBlock( myOff );
-      size_type off = myOff % dequeSize;
-      return myCont->map[ block ][ off ];
+      return *myCur;
    }
 
    pointer operator->() const
    {
-      return &( operator*() );
+      return myCur;
    }
 
    DequeConstIterator& operator++() // preincrement
    {
       ++myOff;
+      if( ++myCur == myLast ) // stepped off the end of the block
+         setBlock();
       return *this;
    }
 
@@ -84,6 +139,10 @@ public:
    DequeConstIterator& operator--() // predecrement
    {
       --myOff;
+      if( myCur == myFirst ) // step back into the previous block
+         setBlock();
+      else
+         --myCur;
       return *this;
    }
 
@@ -98,6 +157,11 @@ public:
    DequeConstIterator& operator+=( const difference_type off )
    {
       myOff += off;
+      difference_type col = ( myCur - myFirst ) + off;
+      if( myFirst != nullptr && col >= 0 && col < static_cast< difference_type >( MyDeque::dequeSize ) )
+         myCur += off; // still inside the cached block
+      else
+         setBlock();
       return *this;
    }
 
@@ -170,6 +234,26 @@ public:
 
    const MyDeque *myCont; // keep a pointer to deque
    size_type myOff;       // offset of element in deque
+
+private:
+   // cache the bounds of the block holding myOff, so that dereferencing and
+   // stepping inside a block never touch the map
+   void setBlock()
+   {
+      if( myCont != nullptr && myCont->map != nullptr &&
+          myCont->map[ myCont->getBlock( myOff ) ] != nullptr )
+      {
+         myFirst = myCont->map[ myCont->getBlock( myOff ) ];
+         myLast = myFirst + MyDeque::dequeSize;
+         myCur = myFirst + myOff % MyDeque::dequeSize;
+      }
+      else // no block allocated there yet, e.g. end() on a block boundary
+         myCur = myFirst = myLast = nullptr;
+   }
+
+   pointer myCur;   // current element
+   pointer myFirst; // beginning of the block holding the current element
+   pointer myLast;  // end of the block holding the current element
 };
 
 
@@ -271,8 +355,188 @@ public:
    }
 };
 
+// memory held by a deque, as reported by deque::memory_stats()
+struct DequeMemoryStats
+{
+   size_t mapBytes;     // bytes in the map
+   size_t blockBytes;   // bytes in allocated blocks, spare blocks included
+   size_t totalBytes;   // mapBytes + blockBytes
+   size_t mapSlots;     // slots in the map
+   size_t nullSlots;    // map slots without a block
+   size_t blocks;       // blocks in the map
+   size_t liveBlocks;   // blocks holding at least one element
+   size_t spareBlocks;  // blocks on the spare list
+   size_t frontSlack;   // raw slots in the first live block, before the first element
+   size_t backSlack;    // raw slots in the last live block, after the last element
+   double occupancy;    // elements per slot in allocated blocks; 0 without blocks
+   size_t growthEvents; // times the map was allocated or grown
+};
+
+// opt-in parallel copy and fill of trivially copyable elements: an operation
+// on at least threshold elements hands each of threads workers its own run of
+// blocks. threads == 1, the default, keeps every operation on the calling thread.
+// The workers live in one pool shared by every deque, started on first use and
+// grown as threads rises; either setting may change while deques are in use
+struct DequeParallel
+{
+   static inline std::atomic< unsigned > threads{ 1 };             // workers, the calling thread included
+   static inline std::atomic< size_t > threshold{ size_t( 1 ) << 24 }; // fewest elements worth splitting
+
+   // return whether an operation on count elements is split across workers
+   static bool splits( size_t count )
+   {
+      return count > 0 && threads.load( std::memory_order_relaxed ) > 1 &&
+             count >= threshold.load( std::memory_order_relaxed );
+   }
+
+   // call work( first, last ) on one range per worker, the ranges covering
+   // [ 0, count ) with every inner boundary a multiple of grain; the calling
+   // thread takes the first range and then waits for the others
+   template< typename Work >
+   static void run( size_t count, size_t grain, Work work )
+   {
+      if( count == 0 )
+         return;
+
+      size_t units = ( count + grain - 1 ) / grain;
+      size_t wanted = threads.load( std::memory_order_relaxed );
+      size_t workers = wanted < units ? wanted : units;
+      Batch batch;
+      try
+      {
+         for( size_t w = 1; w < workers; w++ )
+         {
+            size_t first = units * w / workers * grain;
+            size_t last = units * ( w + 1 ) / workers * grain;
+            if( last > count )
+               last = count;
+            pool().submit( batch, workers - 1, [ &work, first, last ]() { work( first, last ); } );
+         }
+         size_t last = units / workers * grain;
+         work( size_t( 0 ), last < count ? last : count );
+      }
+      catch( ... )
+      {  // the ranges already handed out refer to work: let them finish first
+         batch.wait();
+         throw;
+      }
+      batch.wait();
+      if( batch.error )
+         std::rethrow_exception( batch.error );
+   }
+
+private:
+   // the ranges of one call to run still in the pool, and the first
+   // exception any of them raised
+   struct Batch
+   {
+      std::mutex mutex;
+      std::condition_variable done;
+      size_t pending = 0;
+      std::exception_ptr error;
+
+      // record that one range finished, raising error if it is not null
+      void finish( std::exception_ptr rangeError )
+      {
+         std::lock_guard< std::mutex > lock( mutex );
+         if( rangeError && !error )
+            error = rangeError;
+         if( --pending == 0 )
+            done.notify_all();
+      }
+
+      // block until every range handed out has finished
+      void wait()
+      {
+         std::unique_lock< std::mutex > lock( mutex );
+         done.wait( lock, [ this ]() { return pending == 0; } );
+      }
+   };
+
+   // worker threads serving ranges from a shared list, joined at exit
+   class Pool
+   {
+   public:
+      ~Pool()
+      {
+         {
+            std::lock_guard< std::mutex > lock( mutex );
+            stopping = true;
+         }
+         ready.notify_all();
+         for( std::thread &worker : workers )
+            worker.join();
+      }
+
+      // queue task as a range of batch, first starting workers until there
+      // are at least wanted; a throw leaves batch without the task
+      void submit( Batch &batch, size_t wanted, std::function< void() > task )
+      {
+         {
+            std::lock_guard< std::mutex > lock( mutex );
+            while( workers.size() < wanted )
+               workers.emplace_back( [ this ]() { serve(); } );
+            tasks.push_back( Task{ &batch, std::move( task ) } );
+
+            // counted before any worker can take the task
+            std::lock_guard< std::mutex > batchLock( batch.mutex );
+            ++batch.pending;
+         }
+         ready.notify_one();
+      }
+
+   private:
+      struct Task
+      {
+         Batch *batch;
+         std::function< void() > work;
+      };
+
+      // run queued tasks until the pool is destroyed
+      void serve()
+      {
+         for( ;; )
+         {
+            Task task;
+            {
+               std::unique_lock< std::mutex > lock( mutex );
+               ready.wait( lock, [ this ]() { return stopping || !tasks.empty(); } );
+               if( tasks.empty() )
+                  return;
+               task = std::move( tasks.back() );
+               tasks.pop_back();
+            }
+
+            std::exception_ptr error;
+            try
+            {
+               task.work();
+            }
+            catch( ... )
+            {
+               error = std::current_exception();
+            }
+            task.batch->finish( error );
+         }
+      }
+
+      std::mutex mutex;
+      std::condition_variable ready;
+      std::vector< std::thread > workers;
+      std::vector< Task > tasks; // taken from the back; their order does not matter
+      bool stopping = false;
+   };
+
+   // the pool every deque shares
+   static Pool &pool()
+   {
+      static Pool instance;
+      return instance;
+   }
+};
+
 // CLASS TEMPLATE DequeVal
-template< typename Ty >
+template< typename Ty, typename BlockPolicy = DequeDefaultBlock >
 class DequeVal // base class for deque to hold data
 {
 public:
@@ -285,41 +549,56 @@ public:
    using const_reference = const value_type &;
    using MapPtr = Ty **;
 
+   // elements per block (a power of 2)
+   static constexpr size_type dequeSize = BlockPolicy::template elements< Ty >();
+
+   // most blocks kept on the spare list; freed blocks beyond it go back to the heap
+   static constexpr size_type maxSpare = 8;
+
    DequeVal() // initialize values
       : map(),
       mapSize( 0 ),
       myOff( 0 ),
-      mySize( 0 )
+      mySize( 0 ),
+      spare(),
+      numSpare( 0 ),
+      numGrowths( 0 ),
+      slab( nullptr ),
+      slabBlocks( 0 )
    {
    }
 
    // determine block from offset
    size_type getBlock( size_type off ) const
    {
-      // elements per block (a power of 2)
-      size_type dequeSize = sizeof( value_type ) <= 1 ? 16 :
-                            sizeof( value_type ) <= 2 ?  8 :
-                            sizeof( value_type ) <= 4 ?  4 :
-                            sizeof( value_type ) <= 8 ?  2 : 1;
-
-      return off % ( dequeSize * mapSize ) / dequeSize;
-//      return ( off / dequeSize ) & ( mapSize - 1 );
+      return ( off / dequeSize ) & ( mapSize - 1 ); // mapSize is zero or 2^N
+//      return off % ( dequeSize * mapSize ) / dequeSize;
    }
 
    MapPtr map;        // pointer to array of pointers to blocks
    size_type mapSize; // size of map array, zero or 2^N
    size_type myOff;   // offset of initial element
    size_type mySize;  // current length of sequence
+
+   pointer spare[ maxSpare ]; // vacated blocks, kept for reuse
+   size_type numSpare;        // number of blocks on the spare list
+   size_type numGrowths;      // times the map was allocated or grown
+   pointer slab;              // storage the fill constructor carved its blocks from
+   size_type slabBlocks;      // number of blocks in slab
 };
 
 
 // CLASS TEMPLATE deque
-template< typename Ty >
+template< typename Ty, typename BlockPolicy = DequeDefaultBlock, typename Alloc = std::allocator< Ty > >
 class deque // circular queue of pointers to blocks
 {
 private:
    using MapPtr = Ty **;
-   using ScaryVal = DequeVal< Ty >;
+   using ScaryVal = DequeVal< Ty, BlockPolicy >;
+   using BlockAlloc = typename std::allocator_traits< Alloc >::template rebind_alloc< Ty >;
+   using BlockTraits = std::allocator_traits< BlockAlloc >;
+   using MapAlloc = typename BlockTraits::template rebind_alloc< Ty * >;
+   using MapTraits = std::allocator_traits< MapAlloc >;
 
 public:
    using value_type = Ty;
@@ -329,21 +608,31 @@ public:
    using const_pointer = const value_type *;
    using reference = value_type &;
    using const_reference = const value_type &;
+   using allocator_type = Alloc;
 
    using iterator = DequeIterator< ScaryVal >;
    using const_iterator = DequeConstIterator< ScaryVal >;
 
    // construct empty deque
    deque()
-      : myData()
+      : myData(),
+        myAlloc()
+   {
+   }
+
+   // construct empty deque with allocator
+   explicit deque( const Alloc &al )
+      : myData(),
+        myAlloc( al )
    {
    }
 
    // fill constructor
    // Constructs a container with "count" elements.
    // Each element is initialized as 0.
-   deque( size_type count, const value_type &val )
-      : myData()
+   deque( size_type count, const value_type &val, const Alloc &al = Alloc() )
+      : myData(),
+        myAlloc( al )
    {
       if( count == 0 )
       {
@@ -352,36 +641,80 @@ public:
       }
       else
       {
-          size_type dequeSize = compDequeSize();
-          myData.mapSize = 8;
-          while (count > dequeSize * (myData.mapSize - 1)) {
-              myData.mapSize *= 2;
-          }
-          myData.map = new pointer[myData.mapSize]();
-          //create 1-dimension dynamic array(pointer1 to pointer2)
-          for (size_t i = 0; count > myData.mySize; i++) {
-              myData.map[i] = new value_type[dequeSize]();
-              myData.mySize += dequeSize;
-          }
-          //create 2-dimension dynamic array(pointer2 to value type)
-          //fill array
-          myData.mySize = 0;
-          
-          for (size_t i = 0; i < myData.mapSize; i++) {
-              for (size_t j = 0; j < dequeSize; j++) {
-                  myData.map[i][j] = val;
-                  myData.mySize++;
-                  if (myData.mySize == count) {
-                      break;
-                  }
-              }
-              if (myData.mySize == count) {
-                  break;
-              }
-          }
+         size_type dequeSize = compDequeSize(); // elements per block (a power of 2)
+         myData.mapSize = 8;
+         while( count > dequeSize * ( myData.mapSize - 1 ) )
+            myData.mapSize *= 2;
+         myData.map = allocMap( myData.mapSize );
+         ++myData.numGrowths;
+
+         // a constructor that throws never runs ~deque, so on a throw destroy
+         // the elements filled so far and release the slab and the map here
+         try
+         {
+            // carve every block out of one contiguous slab: one allocation instead
+            // of one per block, and the elements land in a single sweep of memory
+            myData.slabBlocks = ( count + dequeSize - 1 ) / dequeSize;
+            myData.slab = BlockTraits::allocate( myAlloc, myData.slabBlocks * dequeSize );
+            for( size_type i = 0; i < myData.slabBlocks; i++ )
+               myData.map[ i ] = myData.slab + i * dequeSize;
+
+            if( std::is_trivially_copyable< value_type >::value && DequeParallel::splits( count ) )
+            {  // each worker fills its own run of blocks of the slab
+               DequeParallel::run( count, dequeSize, [ this, &val ]( size_type first, size_type last )
+               {
+                  fillRun( myData.slab + first, last - first, val );
+               } );
+               myData.mySize = count;
+            }
+            else // fill a block at a time
+               for( size_type i = 0; myData.mySize < count; i++ )
+               {
+                  size_type run = count - myData.mySize < dequeSize ? count - myData.mySize : dequeSize;
+                  fillRun( myData.map[ i ], run, val );
+                  myData.mySize += run;
+               }
+         }
+         catch( ... )
+         {
+            clear();
+            throw;
+         }
       }
+   }
 
-      myData.mySize = count;
+   // construct from [ first, last ); a range that can be read twice is
+   // measured first, so the map is sized once and every block allocated once
+   template< typename InIt,
+             typename = typename std::iterator_traits< InIt >::iterator_category >
+   deque( InIt first, InIt last, const Alloc &al = Alloc() )
+      : myData(),
+        myAlloc( al )
+   {
+      try
+      {
+         constructRange( first, last, typename std::iterator_traits< InIt >::iterator_category() );
+      }
+      catch( ... )
+      {  // no ~deque after a throw here: release what the range built so far
+         clear();
+         throw;
+      }
+   }
+
+   // construct from the elements of list
+   deque( std::initializer_list< value_type > list, const Alloc &al = Alloc() )
+      : deque( list.begin(), list.end(), al )
+   {
+   }
+
+   // construct by moving right: its map and blocks change hands in O(1),
+   // leaving right empty
+   deque( deque &&right ) noexcept
+      : myData( right.myData ),
+        myAlloc( std::move( right.myAlloc ) )
+   {
+      right.myData = ScaryVal();
    }
 
    // destroy the deque
@@ -390,6 +723,36 @@ public:
       clear();
    }
 
+   // return allocator object for values
+   allocator_type get_allocator() const
+   {
+      return allocator_type( myAlloc );
+   }
+
+   // move right into this deque; with an allocator that propagates or compares
+   // equal, the map and blocks change hands in O(1), otherwise the elements are
+   // moved one by one into blocks of this deque's own. right is left empty
+   deque& operator=( deque &&right ) noexcept( BlockTraits::propagate_on_container_move_assignment::value ||
+                                               BlockTraits::is_always_equal::value )
+   {
+      if( &right != this )
+      {
+         clear();
+         if constexpr( BlockTraits::propagate_on_container_move_assignment::value )
+            myAlloc = std::move( right.myAlloc );
+
+         if( BlockTraits::propagate_on_container_move_assignment::value || myAlloc == right.myAlloc )
+         {
+            myData = right.myData;
+            right.myData = ScaryVal();
+         }
+         else
+            moveElements( right );
+      }
+
+      return *this;
+   }
+
    // return iterator for beginning of mutable sequence
    iterator begin()
    {
@@ -419,20 +782,106 @@ public:
       return iterator( where.myOff, &myData );
    }
 
+   // call func( p, count ) for each run of elements stored contiguously
+   // in one block, in sequence order
+   template< typename Func >
+   void for_each_segment( Func func )
+   {
+      size_type dequeSize = compDequeSize(); // elements per block (a power of 2)
+      size_type off = myData.myOff;
+      for( size_type left = myData.mySize; left > 0; )
+      {
+         size_type col = off % dequeSize;
+         size_type count = dequeSize - col < left ? dequeSize - col : left;
+         func( static_cast< pointer >( myData.map[ getBlock( off ) ] + col ), count );
+         off += count;
+         left -= count;
+      }
+   }
+
+   // call func( p, count ) for each run of elements stored contiguously
+   // in one block, in sequence order
+   template< typename Func >
+   void for_each_segment( Func func ) const
+   {
+      size_type dequeSize = compDequeSize(); // elements per block (a power of 2)
+      size_type off = myData.myOff;
+      for( size_type left = myData.mySize; left > 0; )
+      {
+         size_type col = off % dequeSize;
+         size_type count = dequeSize - col < left ? dequeSize - col : left;
+         func( static_cast< const_pointer >( myData.map[ getBlock( off ) ] + col ), count );
+         off += count;
+         left -= count;
+      }
+   }
+
    // erase all
    void clear()
    {
       if( myData.mapSize > 0 )
       {
+         if( !std::is_trivially_destructible< value_type >::value )
+            for( size_type off = myData.myOff; off < myData.myOff + myData.mySize; off++ )
+               destroy( &myData.map[ getBlock( off ) ][ off % compDequeSize() ] );
+
          for( size_type i = 0; i < myData.mapSize; i++ )
-            delete[] myData.map[ i ];
-         delete[] myData.map;
+            if( myData.map[ i ] != nullptr )
+               releaseBlock( myData.map[ i ] );
+         for( size_type i = 0; i < myData.numSpare; i++ )
+            releaseBlock( myData.spare[ i ] );
+         if( myData.slab != nullptr )
+            BlockTraits::deallocate( myAlloc, myData.slab, myData.slabBlocks * compDequeSize() );
+         freeMap( myData.map, myData.mapSize );
 
          myData.mapSize = 0;
          myData.mySize = 0;
          myData.myOff = 0;
+         myData.numSpare = 0;
          myData.map = nullptr;
+         myData.slab = nullptr;
+         myData.slabBlocks = 0;
+      }
+   }
+
+   // erase all, keeping the map and every block for reuse
+   void clear_keep_capacity()
+   {
+      if( !std::is_trivially_destructible< value_type >::value )
+         for( size_type off = myData.myOff; off < myData.myOff + myData.mySize; off++ )
+            destroy( &myData.map[ getBlock( off ) ][ off % compDequeSize() ] );
+
+      myData.myOff = 0;
+      myData.mySize = 0;
+   }
+
+   // report the memory the deque holds; O( mapSize ), without allocating
+   DequeMemoryStats memory_stats() const
+   {
+      size_type dequeSize = compDequeSize(); // elements per block (a power of 2)
+      DequeMemoryStats stats = DequeMemoryStats();
+      stats.mapSlots = myData.mapSize;
+      for( size_type i = 0; i < myData.mapSize; i++ )
+         if( myData.map[ i ] != nullptr )
+            stats.blocks++;
+      stats.nullSlots = myData.mapSize - stats.blocks;
+      stats.spareBlocks = myData.numSpare;
+      if( myData.mySize > 0 )
+      {
+         stats.liveBlocks = ( myData.myOff + myData.mySize - 1 ) / dequeSize - myData.myOff / dequeSize + 1;
+         if( stats.liveBlocks > myData.mapSize ) // first and last element share a block
+            stats.liveBlocks = myData.mapSize;
+         stats.frontSlack = myData.myOff % dequeSize;
+         stats.backSlack = ( dequeSize - ( myData.myOff + myData.mySize ) % dequeSize ) % dequeSize;
       }
+
+      size_type slots = ( stats.blocks + stats.spareBlocks ) * dequeSize;
+      stats.mapBytes = myData.mapSize * sizeof( pointer );
+      stats.blockBytes = slots * sizeof( value_type );
+      stats.totalBytes = stats.mapBytes + stats.blockBytes;
+      stats.occupancy = slots == 0 ? 0 : static_cast< double >( myData.mySize ) / slots;
+      stats.growthEvents = myData.numGrowths;
+      return stats;
    }
 
 private:
@@ -444,13 +893,174 @@ private:
 //      return ( ( myData.off / compDequeSize() ) & ( myData.mapSize - 1 ) );
    }
 
-   size_type compDequeSize()
+   // construct an element from args in the raw slot p
+   template< typename... Args >
+   void construct( pointer p, Args &&...args )
+   {
+      BlockTraits::construct( myAlloc, p, std::forward< Args >( args )... );
+   }
+
+   // destroy the element in slot p, leaving the slot raw
+   void destroy( pointer p )
+   {
+      BlockTraits::destroy( myAlloc, p );
+   }
+
+   // allocate raw storage for one block; no element is constructed
+   pointer allocBlock()
+   {
+      return BlockTraits::allocate( myAlloc, compDequeSize() );
+   }
+
+   // release a block of raw storage whose elements are all destroyed;
+   // blocks carved from the slab go back with the slab, in clear
+   void releaseBlock( pointer block )
+   {
+      if( !inSlab( block ) )
+         BlockTraits::deallocate( myAlloc, block, compDequeSize() );
+   }
+
+   // construct [ first, last ) in this empty deque from offset 0, with the
+   // map sized once and the blocks carved from one slab, from the length of the range
+   template< typename FwdIt >
+   void constructRange( FwdIt first, FwdIt last, std::forward_iterator_tag )
+   {
+      size_type count = static_cast< size_type >( std::distance( first, last ) );
+      if( count > 0 )
+      {
+         size_type dequeSize = compDequeSize(); // elements per block (a power of 2)
+         size_type newMapSize = 8;
+         while( count > dequeSize * ( newMapSize - 1 ) )
+            newMapSize *= 2;
+         growMap( newMapSize );
+
+         myData.slabBlocks = ( count + dequeSize - 1 ) / dequeSize;
+         myData.slab = BlockTraits::allocate( myAlloc, myData.slabBlocks * dequeSize );
+         for( size_type i = 0; i < myData.slabBlocks; i++ )
+            myData.map[ i ] = myData.slab + i * dequeSize;
+
+         for( ; first != last; ++first )
+         {
+            construct( myData.slab + myData.mySize, *first );
+            ++myData.mySize;
+         }
+      }
+   }
+
+   // construct [ first, last ) in this empty deque when the range can be
+   // read only once, growing block by block as the elements arrive
+   template< typename InIt >
+   void constructRange( InIt first, InIt last, std::input_iterator_tag )
+   {
+      size_type dequeSize = compDequeSize(); // elements per block (a power of 2)
+      for( ; first != last; ++first )
+      {
+         size_type block = myData.mySize / dequeSize;
+         if( myData.mySize % dequeSize == 0 ) // the last block is full: start the next
+         {
+            if( block + 1 >= myData.mapSize ) // keep a slot to spare, as the fill constructor does
+               growMap( myData.mapSize > 0 ? 2 * myData.mapSize : 8 );
+            myData.map[ block ] = allocBlock();
+         }
+         construct( myData.map[ block ] + myData.mySize % dequeSize, *first );
+         ++myData.mySize;
+      }
+   }
+
+   // move the blocks, which start at offset 0, to a map of newMapSize slots
+   void growMap( size_type newMapSize )
+   {
+      MapPtr newMap = allocMap( newMapSize );
+      for( size_type i = 0; i < myData.mapSize; i++ )
+         newMap[ i ] = myData.map[ i ];
+      if( myData.mapSize > 0 )
+         freeMap( myData.map, myData.mapSize );
+      myData.map = newMap;
+      myData.mapSize = newMapSize;
+      ++myData.numGrowths;
+   }
+
+   // construct count copies of val in the raw slots at p; fill_n over
+   // trivially copyable elements compiles to wide stores of val. If a copy
+   // throws, the ones already built are destroyed before it propagates
+   void fillRun( pointer p, size_type count, const value_type &val )
+   {
+      if constexpr( std::is_trivially_copyable< value_type >::value )
+         std::fill_n( p, count, val );
+      else
+      {
+         size_type i = 0;
+         try
+         {
+            for( ; i < count; i++ )
+               construct( p + i, val );
+         }
+         catch( ... )
+         {  // all or nothing: the caller counts whole runs
+            while( i > 0 )
+               destroy( p + --i );
+            throw;
+         }
+      }
+   }
+
+   // return whether block was carved from the slab
+   bool inSlab( pointer block ) const
+   {
+      return std::less_equal< pointer >()( myData.slab, block ) &&
+             std::less< pointer >()( block, myData.slab + myData.slabBlocks * compDequeSize() );
+   }
+
+   // allocate a map of count null block pointers
+   MapPtr allocMap( size_type count )
+   {
+      MapAlloc mapAlloc( myAlloc );
+      MapPtr map = MapTraits::allocate( mapAlloc, count );
+      for( size_type i = 0; i < count; i++ )
+         map[ i ] = nullptr;
+      return map;
+   }
+
+   // release a map of count block pointers
+   void freeMap( MapPtr map, size_type count )
+   {
+      MapAlloc mapAlloc( myAlloc );
+      MapTraits::deallocate( mapAlloc, map, count );
+   }
+
+   // move right's elements one by one to the same offsets in a map and blocks
+   // of this (empty) deque's own, then clear right. Each element is counted
+   // as soon as it is built, so a throw leaves this deque valid
+   void moveElements( deque &right )
+   {
+      size_type dequeSize = compDequeSize(); // elements per block (a power of 2)
+      if( right.myData.mySize > 0 )
+      {
+         myData.map = allocMap( right.myData.mapSize );
+         myData.mapSize = right.myData.mapSize;
+         myData.myOff = right.myData.myOff;
+         ++myData.numGrowths;
+         for( size_type off = myData.myOff; off < myData.myOff + right.myData.mySize; off++ )
+         {
+            MapPtr block = myData.map + getBlock( off );
+            if( *block == nullptr )
+               *block = allocBlock();
+            construct( &( *block )[ off % dequeSize ],
+                       std::move( right.myData.map[ right.getBlock( off ) ][ off % dequeSize ] ) );
+            ++myData.mySize;
+         }
+      }
+      right.clear();
+   }
+
+   // elements per block (a power of 2)
+   static constexpr size_type compDequeSize()
    {
-      return sizeof( value_type ) <= 1 ? 16 : sizeof( value_type ) <= 2 ? 8 :
-             sizeof( value_type ) <= 4 ?  4 : sizeof( value_type ) <= 8 ? 2 : 1;
+      return ScaryVal::dequeSize;
    }
 
    ScaryVal myData;
+   BlockAlloc myAlloc; // allocates blocks and elements; rebound for the map
 };
 
 #endif
\ No newline at end of file
@@ -1,6 +1,51 @@
 #ifndef DEQUE_H
 #define DEQUE_H
 
+#include <algorithm>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+// CLASS TEMPLATE DequeBlockBytes
+// block geometry policy: each block spans Bytes bytes, rounded down to
+// a power of 2 elements (at least one element per block)
+template< size_t Bytes >
+struct DequeBlockBytes
+{
+   template< typename Ty >
+   static constexpr size_t elements()
+   {
+      return floorPow2( Bytes / sizeof( Ty ) );
+   }
+
+private:
+   static constexpr size_t floorPow2( size_t n )
+   {
+      return n <= 1 ? 1 : 2 * floorPow2( n / 2 );
+   }
+};
+
+// CLASS TEMPLATE DequeBlockElements
+// block geometry policy: each block holds Count elements
+template< size_t Count >
+struct DequeBlockElements
+{
+   static_assert( Count > 0 && ( Count & ( Count - 1 ) ) == 0,
+                  "elements per block must be a power of 2" );
+
+   template< typename Ty >
+   static constexpr size_t elements()
+   {
+      return Count;
+   }
+};
+
+// 16 bytes per block: 16, 8, 4, 2 or 1 elements for 1, 2, 4, 8 or >8 byte types
+using DequeDefaultBlock = DequeBlockBytes< 16 >;
+
 // CLASS TEMPLATE DequeConstIterator
 template< typename MyDeque >
 class DequeConstIterator // iterator for nonmutable deque
@@ -9,6 +54,7 @@ private:
    using size_type = typename MyDeque::size_type;
 
 public:
+   using iterator_category = std::random_access_iterator_tag;
    using value_type = typename MyDeque::value_type;
    using difference_type = typename MyDeque::difference_type;
    using pointer = typename MyDeque::const_pointer;
@@ -16,21 +62,28 @@ public:
 
    // construct with null pointer
    DequeConstIterator()
-      : myOff( 0 ),
-        myCont( nullptr )
+      : myCont( nullptr ),
+        myOff( 0 ),
+        myCur( nullptr ),
+        myFirst( nullptr ),
+        myLast( nullptr )
    {
    }
 
    // construct with offset off in *pDeque
    DequeConstIterator( size_type off, const MyDeque *pDeque )
-      : myOff( off ),
-        myCont( pDeque )
+      : myCont( pDeque ),
+        myOff( off )
    {
+      setBlock();
    }
 
    DequeConstIterator( const DequeConstIterator &right ) // copy constructor
-      : myOff( right.myOff ),
-        myCont( right.myCont )
+      : myCont( right.myCont ),
+        myOff( right.myOff ),
+        myCur( right.myCur ),
+        myFirst( right.myFirst ),
+        myLast( right.myLast )
    {
    }
 
@@ -45,45 +98,28 @@ public:
       {
          myCont = right.myCont;
          myOff = right.myOff;
+         myCur = right.myCur;
+         myFirst = right.myFirst;
+         myLast = right.myLast;
       }
       return *this; // enables x = y = z, for example
    }
 
    reference operator*() const
    {
-      // elements per block (a power of 2)
-      size_type dequeSize = sizeof( value_type ) <= 1 ? 16 :
-                            sizeof( value_type ) <= 2 ?  8 :
-                            sizeof( value_type ) <= 4 ?  4 :
-                            sizeof( value_type ) <= 8 ?  2 : 1;
-
-//      size_type block = myOff % ( dequeSize * myCont->mapSize ) / dequeSize;
-      size_type block = myCont->getBlock( myOff );
-      size_type off = myOff % dequeSize;
-      return myCont->map[ block ][ off ];
+      return *myCur;
    }
 
    pointer operator->() const
    {
-      // elements per block (a power of 2)
-      size_type dequeSize = sizeof( value_type ) <= 1 ? 16 :
-                            sizeof( value_type ) <= 2 ?  8 :
-                            sizeof( value_type ) <= 4 ?  4 :
-                            sizeof( value_type ) <= 8 ?  2 : 1;
-
-      size_type block = myCont->getBlock( myOff );
-      size_type off = myOff % dequeSize;
-      return &myCont->map[ block ][ off ];
-   }
-/*
-   pointer operator->() const
-   {
-      return &( operator*() );
+      return myCur;
    }
-*/
+
    DequeConstIterator& operator++() // preincrement
    {
       ++myOff;
+      if( ++myCur == myLast ) // stepped off the end of the block
+         setBlock();
       return *this;
    }
 
@@ -97,6 +133,10 @@ public:
    DequeConstIterator& operator--() // predecrement
    {
       --myOff;
+      if( myCur == myFirst ) // step back into the previous block
+         setBlock();
+      else
+         --myCur;
       return *this;
    }
 
@@ -111,6 +151,11 @@ public:
    DequeConstIterator& operator+=( const difference_type off )
    {
       myOff += off;
+      difference_type col = ( myCur - myFirst ) + off;
+      if( myFirst != nullptr && col >= 0 && col < static_cast< difference_type >( MyDeque::dequeSize ) )
+         myCur += off; // still inside the cached block
+      else
+         setBlock();
       return *this;
    }
 
@@ -183,6 +228,26 @@ public:
 
    const MyDeque *myCont; // keep a pointer to deque
    size_type myOff;       // offset of element in deque
+
+private:
+   // cache the bounds of the block holding myOff, so that dereferencing and
+   // stepping inside a block never touch the map
+   void setBlock()
+   {
+      if( myCont != nullptr && myCont->map != nullptr &&
+          myCont->map[ myCont->getBlock( myOff ) ] != nullptr )
+      {
+         myFirst = myCont->map[ myCont->getBlock( myOff ) ];
+         myLast = myFirst + MyDeque::dequeSize;
+         myCur = myFirst + myOff % MyDeque::dequeSize;
+      }
+      else // no block allocated there yet, e.g. end() on a block boundary
+         myCur = myFirst = myLast = nullptr;
+   }
+
+   pointer myCur;   // current element
+   pointer myFirst; // beginning of the block holding the current element
+   pointer myLast;  // end of the block holding the current element
 };
 
 
@@ -284,8 +349,25 @@ public:
    }
 };
 
+// memory held by a deque, as reported by deque::memory_stats()
+struct DequeMemoryStats
+{
+   size_t mapBytes;     // bytes in the map
+   size_t blockBytes;   // bytes in allocated blocks, spare blocks included
+   size_t totalBytes;   // mapBytes + blockBytes
+   size_t mapSlots;     // slots in the map
+   size_t nullSlots;    // map slots without a block
+   size_t blocks;       // blocks in the map
+   size_t liveBlocks;   // blocks holding at least one element
+   size_t spareBlocks;  // blocks on the spare list
+   size_t frontSlack;   // raw slots in the first live block, before the first element
+   size_t backSlack;    // raw slots in the last live block, after the last element
+   double occupancy;    // elements per slot in allocated blocks; 0 without blocks
+   size_t growthEvents; // times the map was allocated or grown
+};
+
 // CLASS TEMPLATE DequeVal
-template< typename Ty >
+template< typename Ty, typename BlockPolicy = DequeDefaultBlock >
 class DequeVal // base class for deque to hold data
 {
 public:
@@ -298,41 +380,54 @@ public:
    using const_reference = const value_type &;
    using MapPtr = Ty **;
 
+   // elements per block (a power of 2)
+   static constexpr size_type dequeSize = BlockPolicy::template elements< Ty >();
+
+   // most blocks kept on the spare list; freed blocks beyond it go back to the heap
+   static constexpr size_type maxSpare = 8;
+
    DequeVal() // initialize values
       : map(),
         mapSize( 0 ),
         myOff( 0 ),
-        mySize( 0 )
+        mySize( 0 ),
+        spare(),
+        numSpare( 0 ),
+        trimPercent( 0 ),
+        numGrowths( 0 )
    {
    }
 
    // determine block from offset
    size_type getBlock( size_type off ) const
    {
-      // elements per block (a power of 2)
-      size_type dequeSize = sizeof( value_type ) <= 1 ? 16 :
-                            sizeof( value_type ) <= 2 ?  8 :
-                            sizeof( value_type ) <= 4 ?  4 :
-                            sizeof( value_type ) <= 8 ?  2 : 1;
-
-      return off % ( dequeSize * mapSize ) / dequeSize;
-//      return ( off / dequeSize ) & ( mapSize - 1 );
+      return ( off / dequeSize ) & ( mapSize - 1 ); // mapSize is zero or 2^N
+//      return off % ( dequeSize * mapSize ) / dequeSize;
    }
 
    MapPtr map;        // pointer to array of pointers to blocks
    size_type mapSize; // size of map array, zero or 2^N
    size_type myOff;   // offset of initial element
    size_type mySize;  // current length of sequence
+
+   pointer spare[ maxSpare ]; // vacated blocks, kept for reuse
+   size_type numSpare;        // number of blocks on the spare list
+   size_type trimPercent;     // occupancy (in percent) below which the map is halved; 0 = never
+   size_type numGrowths;      // times the map was allocated or grown
 };
 
 
 // CLASS TEMPLATE deque
-template< typename Ty >
+template< typename Ty, typename BlockPolicy = DequeDefaultBlock, typename Alloc = std::allocator< Ty > >
 class deque // circular queue of pointers to blocks
 {
 private:
    using MapPtr = Ty **;
-   using ScaryVal = DequeVal< Ty >;
+   using ScaryVal = DequeVal< Ty, BlockPolicy >;
+   using BlockAlloc = typename std::allocator_traits< Alloc >::template rebind_alloc< Ty >;
+   using BlockTraits = std::allocator_traits< BlockAlloc >;
+   using MapAlloc = typename BlockTraits::template rebind_alloc< Ty * >;
+   using MapTraits = std::allocator_traits< MapAlloc >;
 
 public:
    using value_type = Ty;
@@ -342,22 +437,95 @@ public:
    using const_pointer = const value_type *;
    using reference = value_type &;
    using const_reference = const value_type &;
+   using allocator_type = Alloc;
 
    using iterator = DequeIterator< ScaryVal >;
    using const_iterator = DequeConstIterator< ScaryVal >;
 
    // construct empty deque
    deque()
-      : myData()
+      : myData(),
+        myAlloc()
    {
    }
 
+   // construct empty deque with allocator
+   explicit deque( const Alloc &al )
+      : myData(),
+        myAlloc( al )
+   {
+   }
+
+   // construct from [ first, last ); a range that can be read twice is
+   // measured first, so the map is sized once and every block allocated once
+   template< typename InIt,
+             typename = typename std::iterator_traits< InIt >::iterator_category >
+   deque( InIt first, InIt last, const Alloc &al = Alloc() )
+      : myData(),
+        myAlloc( al )
+   {
+      try
+      {
+         constructRange( first, last, typename std::iterator_traits< InIt >::iterator_category() );
+      }
+      catch( ... )
+      {  // no ~deque after a throw here: release what the range built so far
+         clear();
+         throw;
+      }
+   }
+
+   // construct from the elements of list
+   deque( std::initializer_list< value_type > list, const Alloc &al = Alloc() )
+      : deque( list.begin(), list.end(), al )
+   {
+   }
+
+   // construct by moving right: its map and blocks change hands in O(1),
+   // leaving right empty
+   deque( deque &&right ) noexcept
+      : myData( right.myData ),
+        myAlloc( std::move( right.myAlloc ) )
+   {
+      right.myData = ScaryVal();
+   }
+
    // destroy the deque
    ~deque()
    {
       clear();
    }
 
+   // return allocator object for values
+   allocator_type get_allocator() const
+   {
+      return allocator_type( myAlloc );
+   }
+
+   // move right into this deque; with an allocator that propagates or compares
+   // equal, the map and blocks change hands in O(1), otherwise the elements are
+   // moved one by one into blocks of this deque's own. right is left empty
+   deque& operator=( deque &&right ) noexcept( BlockTraits::propagate_on_container_move_assignment::value ||
+                                               BlockTraits::is_always_equal::value )
+   {
+      if( &right != this )
+      {
+         clear();
+         if constexpr( BlockTraits::propagate_on_container_move_assignment::value )
+            myAlloc = std::move( right.myAlloc );
+
+         if( BlockTraits::propagate_on_container_move_assignment::value || myAlloc == right.myAlloc )
+         {
+            myData = right.myData;
+            right.myData = ScaryVal();
+         }
+         else
+            moveElements( right );
+      }
+
+      return *this;
+   }
+
    // return iterator for beginning of mutable sequence
    iterator begin()
    {
@@ -402,16 +570,31 @@ public:
    // insert val at where
    iterator insert( const_iterator where, const value_type &val )
    {
+      return emplace( where, val );
+   }
+
+   // insert val at where, moving it into place
+   iterator insert( const_iterator where, value_type &&val )
+   {
+      return emplace( where, std::move( val ) );
+   }
+
+   // insert an element constructed from args at where
+   template< typename... Args >
+   iterator emplace( const_iterator where, Args &&...args )
+   {
+      value_type val( std::forward< Args >( args )... ); // args may refer into *this
       size_type dequeSize = compDequeSize(); // elements per block (a power of 2)
       size_type off = static_cast< size_type >( where - begin() );
       if( myData.mySize == 0 )
       {
          if( myData.mapSize == 0 )
          {
-            myData.map = new value_type * [ 8 ]();
+            myData.map = allocMap( 8 );
             myData.mapSize = 8;
+            ++myData.numGrowths;
          }
-         size_t row = (off / dequeSize) % myData.mapSize;
+         size_t row = getBlock( off );
          size_t col = off % dequeSize;
          //find forward
          if (row == 0 && col == 0) {
@@ -426,9 +609,9 @@ public:
              col -= 1;
 
          if (myData.map[row] == nullptr) {
-             myData.map[row] = new value_type[dequeSize]();
+             myData.map[row] = allocBlock();
          }
-         myData.map[row][col] = val;
+         construct( &myData.map[row][col], std::move( val ) );
          myData.myOff = row * dequeSize + col;
 
 
@@ -442,65 +625,15 @@ public:
                myData.mapSize <= ( myData.mySize + dequeSize ) / dequeSize )
                doubleMapSize();
             if (myData.myOff >= myData.mapSize * dequeSize) {
-                myData.myOff %= myData.mapSize * dequeSize;
-            }
-
-            //begin,row:i/dequeSize%mapSize, col=i%dequeSize
-            size_t row = (myData.myOff / dequeSize) % myData.mapSize; //begin
-            int targetRow = ((myData.myOff + off - 1) / dequeSize) % myData.mapSize;
-            size_t col = myData.myOff % dequeSize;
-            int targetCol = (myData.myOff + off - 1) % dequeSize;
-            //check that is index out of range?
-            if (targetRow < 0)
-                targetRow += myData.mapSize;
-            if (targetCol < 0)
-                targetCol += dequeSize;
-            //fix the negative index, following:find the forward index of begin
-            if (row == 0 && col == 0) {
-                if (myData.map[row + myData.mapSize - 1] == nullptr) {
-                    myData.map[row + myData.mapSize - 1] = new value_type[dequeSize]();
-                    row += myData.mapSize - 1;
-                    col += dequeSize - 1;
-                }
-            }//map[0][0]
-            else if (col == 0) {
-                if (myData.map[row - 1] == nullptr) {
-                    myData.map[row - 1] = new value_type[dequeSize]();
-                    row--;
-                    col += dequeSize - 1;
-                }
-            }//map[n][0]
-            else {
-                col--;
-            }
-            //following: move forward
-            for (size_t i = 0; i < off; i++) {
-                row = ((i + myData.myOff - 1) / dequeSize) % myData.mapSize;
-                col = (i + myData.myOff - 1) % dequeSize;
-                size_t nextRow, nextCol;
-
-                if (row == myData.mapSize - 1 && col == dequeSize - 1) {
-                    nextRow = 0;
-                    nextCol = 0;
-                }//change to first element;
-                else if (col == dequeSize - 1) {
-                    nextRow = row + 1;
-                    nextCol = 0;
-                }//change to next row
-                else {
-                    nextRow = row;
-                    nextCol = col + 1;
-                }//increase
-
-                myData.map[row][col] = myData.map[nextRow][nextCol];
+                myData.myOff &= myData.mapSize * dequeSize - 1;
             }
 
-            myData.map[targetRow][targetCol] = val;
-
-            if (myData.myOff == 0)
-                myData.myOff = myData.mapSize * dequeSize - 1;//Obegin()-end()?
-            else
-                myData.myOff -= 1;
+            // open a slot in front of begin, then move the first off elements into it
+            size_type capacity = myData.mapSize * dequeSize;
+            allocBlocks( myData.myOff + capacity - 1, 1 );
+            shiftElements( myData.myOff + capacity - 1, myData.myOff + capacity, off );
+            construct( &element( myData.myOff + capacity - 1 + off ), std::move( val ) );
+            myData.myOff = ( myData.myOff + capacity - 1 ) & ( capacity - 1 );
 
 
          }
@@ -514,38 +647,14 @@ public:
                 doubleMapSize();
 
             if (myData.myOff >= myData.mapSize * dequeSize) {
-                myData.myOff %= myData.mapSize * dequeSize;
+                myData.myOff &= myData.mapSize * dequeSize - 1;
             }
 
 
-            size_t row = ((myData.myOff + myData.mySize - 1) / dequeSize) % myData.mapSize;
-            size_t col = (myData.myOff + myData.mySize - 1) % dequeSize;//find last index
-            size_t nextRow = 0, nextCol = 0;
-            size_t targetRow = ((myData.myOff + off) / dequeSize) % myData.mapSize;
-            size_t targetCol = (myData.myOff + off) % dequeSize;
-            if (row == myData.mapSize - 1 && col == dequeSize - 1) {
-                nextRow = 0;
-                nextCol = 0;
-            }
-            else if (col == dequeSize - 1) {
-                nextRow = row + 1;
-                nextCol = 0;
-            }
-            else {
-                nextRow = row;
-                nextCol = col + 1;//find the next of the last
-            }
-            if (myData.map[nextRow] == nullptr) {
-                myData.map[nextRow] = new value_type[dequeSize]();
-            }
-            for (size_t i = 0; i < myData.mySize - off; i++) {
-                row = ((myData.myOff + myData.mySize - i - 1) / dequeSize) % myData.mapSize;
-                col = (myData.myOff + myData.mySize - i - 1) % dequeSize;
-                myData.map[nextRow][nextCol] = myData.map[row][col];
-                nextRow = row;
-                nextCol = col;
-            }
-            myData.map[targetRow][targetCol] = val;
+            // open a slot behind end, then move the elements at and after where into it
+            allocBlocks( myData.myOff + myData.mySize, 1 );
+            shiftElements( myData.myOff + off + 1, myData.myOff + off, myData.mySize - off );
+            construct( &element( myData.myOff + off ), std::move( val ) );
 
 
          }
@@ -555,23 +664,282 @@ public:
       return begin() + static_cast< difference_type >( off );
    }
 
+   // insert count copies of val at where
+   iterator insert( const_iterator where, size_type count, const value_type &val )
+   {
+      size_type off = static_cast< size_type >( where - begin() );
+      fillGap( off, count, [ this, &val ]( pointer p ) { construct( p, val ); } );
+      return begin() + static_cast< difference_type >( off );
+   }
+
+   // insert [ first, last ) at where
+   template< typename InIt,
+             typename = typename std::iterator_traits< InIt >::iterator_category >
+   iterator insert( const_iterator where, InIt first, InIt last )
+   {
+      return insertRange( where, first, last,
+                          typename std::iterator_traits< InIt >::iterator_category() );
+   }
+
+   // return first element of mutable sequence
+   reference front()
+   {
+      return element( myData.myOff );
+   }
+
+   // return first element of nonmutable sequence
+   const_reference front() const
+   {
+      return myData.map[ getBlock( myData.myOff ) ][ myData.myOff % compDequeSize() ];
+   }
+
+   // return last element of mutable sequence
+   reference back()
+   {
+      return element( myData.myOff + myData.mySize - 1 );
+   }
+
+   // return last element of nonmutable sequence
+   const_reference back() const
+   {
+      size_type off = myData.myOff + myData.mySize - 1;
+      return myData.map[ getBlock( off ) ][ off % compDequeSize() ];
+   }
+
+   // insert val at the beginning
+   void push_front( const value_type &val )
+   {
+      emplace_front( val );
+   }
+
+   // insert val at the beginning
+   void push_front( value_type &&val )
+   {
+      emplace_front( std::move( val ) );
+   }
+
+   // insert val at the end
+   void push_back( const value_type &val )
+   {
+      emplace_back( val );
+   }
+
+   // insert val at the end
+   void push_back( value_type &&val )
+   {
+      emplace_back( std::move( val ) );
+   }
+
+   // insert an element constructed from args at the beginning
+   template< typename... Args >
+   reference emplace_front( Args &&...args )
+   {
+      growAtEnd( myData.myOff );
+      size_type capacity = myData.mapSize * compDequeSize();
+      size_type off = ( myData.myOff + capacity - 1 ) & ( capacity - 1 );
+      reference slot = slotAt( off );
+      construct( &slot, std::forward< Args >( args )... );
+      myData.myOff = off;
+      ++myData.mySize;
+      return slot;
+   }
+
+   // insert an element constructed from args at the end
+   template< typename... Args >
+   reference emplace_back( Args &&...args )
+   {
+      growAtEnd( myData.myOff + myData.mySize );
+      size_type off = myData.myOff + myData.mySize;
+      reference slot = slotAt( off );
+      construct( &slot, std::forward< Args >( args )... );
+      ++myData.mySize;
+      return slot;
+   }
+
+   // erase element at beginning
+   void pop_front()
+   {
+      size_type off = myData.myOff;
+      destroy( &element( off ) );
+      if( --myData.mySize == 0 )
+         myData.myOff = 0;
+      else
+         ++myData.myOff;
+      vacate( off );
+      autoTrim();
+   }
+
+   // erase element at end
+   void pop_back()
+   {
+      size_type off = myData.myOff + myData.mySize - 1;
+      destroy( &element( off ) );
+      if( --myData.mySize == 0 )
+         myData.myOff = 0;
+      vacate( off );
+      autoTrim();
+   }
+
+   // call func( p, count ) for each run of elements stored contiguously
+   // in one block, in sequence order
+   template< typename Func >
+   void for_each_segment( Func func )
+   {
+      size_type dequeSize = compDequeSize(); // elements per block (a power of 2)
+      size_type off = myData.myOff;
+      for( size_type left = myData.mySize; left > 0; )
+      {
+         size_type col = off % dequeSize;
+         size_type count = dequeSize - col < left ? dequeSize - col : left;
+         func( static_cast< pointer >( myData.map[ getBlock( off ) ] + col ), count );
+         off += count;
+         left -= count;
+      }
+   }
+
+   // call func( p, count ) for each run of elements stored contiguously
+   // in one block, in sequence order
+   template< typename Func >
+   void for_each_segment( Func func ) const
+   {
+      size_type dequeSize = compDequeSize(); // elements per block (a power of 2)
+      size_type off = myData.myOff;
+      for( size_type left = myData.mySize; left > 0; )
+      {
+         size_type col = off % dequeSize;
+         size_type count = dequeSize - col < left ? dequeSize - col : left;
+         func( static_cast< const_pointer >( myData.map[ getBlock( off ) ] + col ), count );
+         off += count;
+         left -= count;
+      }
+   }
+
    // erase all
    void clear()
    {
       if( myData.mapSize > 0 )
       {
+         if( !std::is_trivially_destructible< value_type >::value )
+            for( size_type off = myData.myOff; off < myData.myOff + myData.mySize; off++ )
+               destroy( &element( off ) );
+
          for( size_type i = 0; i < myData.mapSize; i++ )
             if( myData.map[ i ] != nullptr )
-               delete[] myData.map[ i ];
-         delete[] myData.map;
+               releaseBlock( myData.map[ i ] );
+         for( size_type i = 0; i < myData.numSpare; i++ )
+            releaseBlock( myData.spare[ i ] );
+         freeMap( myData.map, myData.mapSize );
 
          myData.mapSize = 0;
          myData.mySize = 0;
          myData.myOff = 0;
+         myData.numSpare = 0;
          myData.map = nullptr;
       }
    }
 
+   // erase all, keeping the map and every block for reuse
+   void clear_keep_capacity()
+   {
+      if( !std::is_trivially_destructible< value_type >::value )
+         for( size_type off = myData.myOff; off < myData.myOff + myData.mySize; off++ )
+            destroy( &element( off ) );
+
+      myData.myOff = 0;
+      myData.mySize = 0;
+   }
+
+   // report the memory the deque holds; O( mapSize ), without allocating
+   DequeMemoryStats memory_stats() const
+   {
+      size_type dequeSize = compDequeSize(); // elements per block (a power of 2)
+      DequeMemoryStats stats = DequeMemoryStats();
+      stats.mapSlots = myData.mapSize;
+      for( size_type i = 0; i < myData.mapSize; i++ )
+         if( myData.map[ i ] != nullptr )
+            stats.blocks++;
+      stats.nullSlots = myData.mapSize - stats.blocks;
+      stats.spareBlocks = myData.numSpare;
+      if( myData.mySize > 0 )
+      {
+         stats.liveBlocks = ( myData.myOff + myData.mySize - 1 ) / dequeSize - myData.myOff / dequeSize + 1;
+         if( stats.liveBlocks > myData.mapSize ) // first and last element share a block
+            stats.liveBlocks = myData.mapSize;
+         stats.frontSlack = myData.myOff % dequeSize;
+         stats.backSlack = ( dequeSize - ( myData.myOff + myData.mySize ) % dequeSize ) % dequeSize;
+      }
+
+      size_type slots = ( stats.blocks + stats.spareBlocks ) * dequeSize;
+      stats.mapBytes = myData.mapSize * sizeof( pointer );
+      stats.blockBytes = slots * sizeof( value_type );
+      stats.totalBytes = stats.mapBytes + stats.blockBytes;
+      stats.occupancy = slots == 0 ? 0 : static_cast< double >( myData.mySize ) / slots;
+      stats.growthEvents = myData.numGrowths;
+      return stats;
+   }
+
+   // release the spare blocks and every block no element lives in, and shrink
+   // the map to the smallest size the elements need; no element is moved
+   void shrink_to_fit()
+   {
+      if( myData.mySize == 0 )
+         clear();
+      else
+      {
+         size_type newMapSize = fitMapSize();
+         shrinkMap( newMapSize < myData.mapSize ? newMapSize : myData.mapSize );
+      }
+   }
+
+   // once fewer than percent of the slots in the map hold elements, release the
+   // unused blocks and halve the map; 0 (the default) turns trimming off.
+   // A percent below 50 leaves a halved map room before it has to grow again
+   void set_auto_trim( size_type percent )
+   {
+      myData.trimPercent = percent;
+   }
+
+   // make room for a total of count elements, growing at the back
+   void reserve( size_type count )
+   {
+      if( count > myData.mySize )
+         reserve_back( count - myData.mySize );
+   }
+
+   // grow the map and allocate the blocks for count more elements at the
+   // beginning, so that many pushes or inserts there allocate nothing
+   void reserve_front( size_type count )
+   {
+      reserveAt( true, count );
+   }
+
+   // grow the map and allocate the blocks for count more elements at the
+   // end, so that many pushes or inserts there allocate nothing
+   void reserve_back( size_type count )
+   {
+      reserveAt( false, count );
+   }
+
+   // return the number of elements the deque holds before its map must grow
+   size_type capacity() const
+   {
+      return myData.mapSize == 0 ? 0 : ( myData.mapSize - 1 ) * compDequeSize();
+   }
+
+   // return the number of elements that can be added at the beginning
+   // without allocating a block or growing the map
+   size_type capacity_front() const
+   {
+      return allocatedRoom( true );
+   }
+
+   // return the number of elements that can be added at the end
+   // without allocating a block or growing the map
+   size_type capacity_back() const
+   {
+      return allocatedRoom( false );
+   }
+
 private:
 
    // determine block from offset
@@ -581,40 +949,499 @@ private:
 //      return ( ( myData.off / compDequeSize() ) & ( myData.mapSize - 1 ) );
    }
 
-   void doubleMapSize()
+   // construct [ first, last ) in this empty deque from offset 0, with the
+   // map sized and the blocks allocated once, from the length of the range
+   template< typename FwdIt >
+   void constructRange( FwdIt first, FwdIt last, std::forward_iterator_tag )
    {
-      if( myData.mapSize > 0 )
+      size_type count = static_cast< size_type >( std::distance( first, last ) );
+      if( count > 0 )
       {
-         size_type oldMapSize = myData.mapSize;
-         myData.mapSize *= 2;
-         value_type **newMap = new value_type * [ myData.mapSize ]();
-
-         size_t dequeSize = compDequeSize();
-         for (size_t i = myData.myOff; i < myData.mySize + myData.myOff; i++) {
-             size_t createRow = (i / dequeSize) % myData.mapSize;
-             newMap[createRow] = new value_type[dequeSize]();
+         size_type dequeSize = compDequeSize(); // elements per block (a power of 2)
+         size_type newMapSize = 8;
+         while( count > dequeSize * ( newMapSize - 1 ) )
+            newMapSize *= 2;
+         myData.map = allocMap( newMapSize );
+         myData.mapSize = newMapSize;
+         ++myData.numGrowths;
+         allocBlocks( 0, count );
+
+         for( ; first != last; ++first )
+         {
+            construct( &element( myData.mySize ), *first );
+            ++myData.mySize;
          }
-         //վ:myOffn@
-         for (int i = myData.myOff; i < myData.myOff + myData.mySize; i++) {
-             int leftrow = (i / dequeSize) % oldMapSize;
-             int rightrow = (i / dequeSize) % myData.mapSize;
-             int col = i % dequeSize;
-             newMap[rightrow][col] = myData.map[leftrow][col];
+      }
+   }
+
+   // construct [ first, last ) in this empty deque when the range can be
+   // read only once, growing block by block as the elements arrive
+   template< typename InIt >
+   void constructRange( InIt first, InIt last, std::input_iterator_tag )
+   {
+      for( ; first != last; ++first )
+         emplace_back( *first );
+   }
+
+   // return element at offset off
+   reference element( size_type off )
+   {
+      return myData.map[ getBlock( off ) ][ off % compDequeSize() ];
+   }
+
+   // insert [ first, last ) at where, sizing the gap from the range length
+   template< typename FwdIt >
+   iterator insertRange( const_iterator where, FwdIt first, FwdIt last, std::forward_iterator_tag )
+   {
+      size_type off = static_cast< size_type >( where - begin() );
+      size_type count = static_cast< size_type >( std::distance( first, last ) );
+      fillGap( off, count, [ this, &first ]( pointer p ) { construct( p, *first ); ++first; } );
+      return begin() + static_cast< difference_type >( off );
+   }
+
+   // insert [ first, last ) at where when the range can be read only once:
+   // append it at the back, then rotate it into place
+   template< typename InIt >
+   iterator insertRange( const_iterator where, InIt first, InIt last, std::input_iterator_tag )
+   {
+      size_type off = static_cast< size_type >( where - begin() );
+      size_type oldSize = myData.mySize;
+      for( ; first != last; ++first )
+         insert( end(), *first );
+      std::rotate( begin() + static_cast< difference_type >( off ),
+                   begin() + static_cast< difference_type >( oldSize ), end() );
+      return begin() + static_cast< difference_type >( off );
+   }
+
+   // open a gap of count slots in front of position off and build an element
+   // in each with build( p ); the new elements count only once all are built.
+   // If one throws, those built are destroyed and the gap closed again, so the
+   // deque keeps its old elements
+   template< typename Build >
+   void fillGap( size_type off, size_type count, Build build )
+   {
+      size_type pos = openGap( off, count );
+      size_type i = 0;
+      try
+      {
+         for( ; i < count; i++ )
+            build( &element( pos + i ) );
+      }
+      catch( ... )
+      {
+         while( i > 0 )
+            destroy( &element( pos + --i ) );
+         closeGap( off, count );
+         throw;
+      }
+      myData.mySize += count;
+   }
+
+   // make room for count elements in front of position off: grow the map
+   // at most once, then shift the shorter side by count in a single pass;
+   // return the offset of the first slot of the gap, whose slots are left raw
+   // and not yet counted in the size
+   size_type openGap( size_type off, size_type count )
+   {
+      size_type dequeSize = compDequeSize(); // elements per block (a power of 2)
+      if( count == 0 )
+         return myData.myOff + off;
+
+      size_type newSize = myData.mySize + count;
+      size_type newMapSize = myData.mapSize > 0 ? myData.mapSize : 8;
+      while( newMapSize <= ( newSize + dequeSize ) / dequeSize )
+         newMapSize *= 2;
+
+      if( myData.mapSize == 0 )
+      {
+         myData.map = allocMap( newMapSize );
+         myData.mapSize = newMapSize;
+         ++myData.numGrowths;
+      }
+      else if( newMapSize > myData.mapSize )
+         growMap( newMapSize );
+
+      myData.myOff &= myData.mapSize * dequeSize - 1;
+      if( off <= myData.mySize / 2 ) // elements before where move forward
+      {
+         size_type newOff = myData.myOff >= count ? myData.myOff - count
+                                                  : myData.myOff + myData.mapSize * dequeSize - count;
+         allocBlocks( newOff, count );
+         shiftElements( newOff, newOff + count, off );
+         myData.myOff = newOff;
+      }
+      else // elements at and after where move backward
+      {
+         allocBlocks( myData.myOff + myData.mySize, count );
+         shiftElements( myData.myOff + off + count, myData.myOff + off, myData.mySize - off );
+      }
+
+      return myData.myOff + off;
+   }
+
+   // undo openGap( off, count ) while the gap is still raw: shift back the
+   // side it moved, so the elements sit where they were before
+   void closeGap( size_type off, size_type count )
+   {
+      if( count == 0 )
+         return;
+
+      if( off <= myData.mySize / 2 ) // the elements before where had moved forward
+      {
+         shiftElements( myData.myOff + count, myData.myOff, off );
+         myData.myOff = ( myData.myOff + count ) & ( myData.mapSize * compDequeSize() - 1 );
+      }
+      else // the elements at and after where had moved backward
+         shiftElements( myData.myOff + off, myData.myOff + off + count, myData.mySize - off );
+   }
+
+   // move count elements from offset src into the raw slots at offset dest,
+   // which may overlap; whole runs inside one block at a time, with memmove
+   // when Ty allows it; the slots left behind are raw
+   void shiftElements( size_type dest, size_type src, size_type count )
+   {
+      size_type dequeSize = compDequeSize(); // elements per block (a power of 2)
+      if( dest < src ) // moving forward: copy runs from the front
+         while( count > 0 )
+         {
+            size_type run = count;
+            if( run > dequeSize - src % dequeSize )
+               run = dequeSize - src % dequeSize;
+            if( run > dequeSize - dest % dequeSize )
+               run = dequeSize - dest % dequeSize;
+            moveRun( &element( dest ), &element( src ), run );
+            dest += run;
+            src += run;
+            count -= run;
+         }
+      else if( dest > src ) // moving backward: copy runs from the back
+         while( count > 0 )
+         {
+            size_type run = count;
+            if( run > ( src + count - 1 ) % dequeSize + 1 )
+               run = ( src + count - 1 ) % dequeSize + 1;
+            if( run > ( dest + count - 1 ) % dequeSize + 1 )
+               run = ( dest + count - 1 ) % dequeSize + 1;
+            count -= run;
+            moveRun( &element( dest + count ), &element( src + count ), run );
          }
+   }
 
-         delete[] myData.map;
+   // move count contiguous elements from src into the raw slots at dest,
+   // which may overlap; each source element is destroyed once moved
+   void moveRun( pointer dest, pointer src, size_type count )
+   {
+      if( std::is_trivially_copyable< value_type >::value )
+         std::memmove( static_cast< void * >( dest ), src, count * sizeof( value_type ) );
+      else if( dest < src )
+         for( size_type i = 0; i < count; i++ )
+         {
+            construct( dest + i, std::move( src[ i ] ) );
+            destroy( src + i );
+         }
+      else
+         for( size_type i = count; i > 0; i-- )
+         {
+            construct( dest + i - 1, std::move( src[ i - 1 ] ) );
+            destroy( src + i - 1 );
+         }
+   }
 
-         myData.map = newMap;
+   // construct an element from args in the raw slot p
+   template< typename... Args >
+   void construct( pointer p, Args &&...args )
+   {
+      BlockTraits::construct( myAlloc, p, std::forward< Args >( args )... );
+   }
+
+   // destroy the element in slot p, leaving the slot raw
+   void destroy( pointer p )
+   {
+      BlockTraits::destroy( myAlloc, p );
+   }
+
+   // take a block from the spare list, or allocate raw storage for one;
+   // no element is constructed
+   pointer allocBlock()
+   {
+      if( myData.numSpare > 0 )
+         return myData.spare[ --myData.numSpare ];
+
+      return BlockTraits::allocate( myAlloc, compDequeSize() );
+   }
+
+   // put a block whose elements are all destroyed on the spare list,
+   // or release it once the list is full
+   void freeBlock( pointer block )
+   {
+      if( myData.numSpare < ScaryVal::maxSpare )
+         myData.spare[ myData.numSpare++ ] = block;
+      else
+         releaseBlock( block );
+   }
+
+   // release a block of raw storage whose elements are all destroyed
+   void releaseBlock( pointer block )
+   {
+      BlockTraits::deallocate( myAlloc, block, compDequeSize() );
+   }
+
+   // allocate a map of count null block pointers
+   MapPtr allocMap( size_type count )
+   {
+      MapAlloc mapAlloc( myAlloc );
+      MapPtr map = MapTraits::allocate( mapAlloc, count );
+      for( size_type i = 0; i < count; i++ )
+         map[ i ] = nullptr;
+      return map;
+   }
+
+   // release a map of count block pointers
+   void freeMap( MapPtr map, size_type count )
+   {
+      MapAlloc mapAlloc( myAlloc );
+      MapTraits::deallocate( mapAlloc, map, count );
+   }
+
+   // before one element is added at offset end (myOff or myOff + mySize),
+   // double the map if that end sits on a block boundary and no block is spare
+   void growAtEnd( size_type end )
+   {
+      size_type dequeSize = compDequeSize(); // elements per block (a power of 2)
+      if( end % dequeSize == 0 &&
+          myData.mapSize <= ( myData.mySize + dequeSize ) / dequeSize )
+      {
+         if( myData.mapSize == 0 )
+         {
+            myData.map = allocMap( 8 );
+            myData.mapSize = 8;
+            ++myData.numGrowths;
+         }
+         else
+            growMap( 2 * myData.mapSize );
+      }
+
+      myData.myOff &= myData.mapSize * dequeSize - 1;
+   }
+
+   // grow the map so count more elements fit without growth, and allocate
+   // the blocks covering them in front of begin or behind end
+   void reserveAt( bool front, size_type count )
+   {
+      if( count == 0 )
+         return;
+
+      size_type dequeSize = compDequeSize(); // elements per block (a power of 2)
+      size_type newMapSize = myData.mapSize > 0 ? myData.mapSize : 8;
+      while( newMapSize <= ( myData.mySize + count - 1 + dequeSize ) / dequeSize )
+         newMapSize *= 2;
+
+      if( myData.mapSize == 0 )
+      {
+         myData.map = allocMap( newMapSize );
+         myData.mapSize = newMapSize;
+         ++myData.numGrowths;
+      }
+      else if( newMapSize > myData.mapSize )
+         growMap( newMapSize );
+      myData.myOff &= myData.mapSize * dequeSize - 1;
+
+      if( front )
+         allocBlocks( myData.myOff + myData.mapSize * dequeSize - count, count );
+      else
+      {
+         allocBlocks( myData.myOff + myData.mySize, count );
+         if( myData.mySize == 0 ) // insert into an empty deque takes the slot before myOff
+            allocBlocks( myData.myOff + myData.mapSize * dequeSize - 1, 1 );
+      }
+   }
+
+   // count the raw slots in allocated blocks, and on the spare list, that the
+   // next elements added at the beginning or at the end would use
+   size_type allocatedRoom( bool front ) const
+   {
+      if( myData.mapSize == 0 )
+         return 0;
+
+      size_type dequeSize = compDequeSize(); // elements per block (a power of 2)
+      size_type limit = capacity() > myData.mySize ? capacity() - myData.mySize : 0;
+      size_type room = 0;
+      size_type off = front ? myData.myOff + myData.mapSize * dequeSize : myData.myOff + myData.mySize;
+      while( room < limit )
+      {
+         size_type slot = front ? off - 1 : off;
+         if( myData.map[ getBlock( slot ) ] == nullptr )
+            break;
+         size_type run = front ? slot % dequeSize + 1 : dequeSize - slot % dequeSize;
+         room += run;
+         off = front ? off - run : off + run;
+      }
+
+      room += myData.numSpare * dequeSize;
+      return room < limit ? room : limit;
+   }
+
+   // return the raw slot at offset off, allocating its block if it is missing
+   reference slotAt( size_type off )
+   {
+      size_type dequeSize = compDequeSize(); // elements per block (a power of 2)
+      MapPtr block = myData.map + getBlock( off );
+      if( *block == nullptr )
+         *block = allocBlock();
+      return ( *block )[ off % dequeSize ];
+   }
+
+   // move the block holding offset off, whose element was just popped,
+   // to the spare list if no element lives in it any more
+   void vacate( size_type off )
+   {
+      size_type block = getBlock( off );
+      if( myData.mySize == 0 ||
+          ( block != getBlock( myData.myOff ) && block != getBlock( myData.myOff + myData.mySize - 1 ) ) )
+      {
+         freeBlock( myData.map[ block ] );
+         myData.map[ block ] = nullptr;
+      }
+   }
+
+   // allocate the missing blocks covering offsets [ off, off + count )
+   void allocBlocks( size_type off, size_type count )
+   {
+      size_type dequeSize = compDequeSize(); // elements per block (a power of 2)
+      for( size_type block = off / dequeSize; block <= ( off + count - 1 ) / dequeSize; block++ )
+         if( myData.map[ block & ( myData.mapSize - 1 ) ] == nullptr )
+            myData.map[ block & ( myData.mapSize - 1 ) ] = allocBlock();
+   }
+
+   // move to a map of newMapSize slots (a power of 2) by relinking block
+   // pointers; every element keeps its offset
+   void growMap( size_type newMapSize )
+   {
+      size_type dequeSize = compDequeSize(); // elements per block (a power of 2)
+      size_type oldMapSize = myData.mapSize;
+      MapPtr newMap = allocMap( newMapSize );
+
+      size_type block = myData.myOff / dequeSize; // first block in use
+      size_type numBlocks = myData.mySize == 0 ? 0 :
+                            ( myData.myOff + myData.mySize - 1 ) / dequeSize - block + 1;
+      for( size_type i = 0; i < numBlocks; i++, block++ )
+      {
+         newMap[ block & ( newMapSize - 1 ) ] = myData.map[ block & ( oldMapSize - 1 ) ];
+         myData.map[ block & ( oldMapSize - 1 ) ] = nullptr;
+      }
+
+      // keep the spare blocks, right behind the ones in use
+      size_type slot = block;
+      for( size_type i = 0; i < oldMapSize; i++ )
+         if( myData.map[ i ] != nullptr )
+         {
+            while( newMap[ slot & ( newMapSize - 1 ) ] != nullptr )
+               ++slot;
+            newMap[ slot & ( newMapSize - 1 ) ] = myData.map[ i ];
+         }
+
+      freeMap( myData.map, oldMapSize );
+      myData.map = newMap;
+      myData.mapSize = newMapSize;
+      ++myData.numGrowths;
+   }
+
+   void doubleMapSize()
+   {
+      if( myData.mapSize > 0 )
+         growMap( 2 * myData.mapSize ); // relink block pointers; no element moves
+   }
+
+   // smallest map (a power of 2, at least 8) the elements fit in with the
+   // slot to spare that the growth rule keeps
+   size_type fitMapSize() const
+   {
+      size_type newMapSize = 8;
+      while( newMapSize <= ( myData.mySize + compDequeSize() ) / compDequeSize() )
+         newMapSize *= 2;
+      return newMapSize;
+   }
+
+   // move to a map of newMapSize slots (a power of 2, at least fitMapSize()) by
+   // relinking the blocks in use; every other block, spares included, is released
+   void shrinkMap( size_type newMapSize )
+   {
+      size_type dequeSize = compDequeSize(); // elements per block (a power of 2)
+      size_type oldMapSize = myData.mapSize;
+      MapPtr newMap = allocMap( newMapSize );
+
+      // in a full map the first and last blocks can be one; relink before clearing
+      size_type first = myData.myOff / dequeSize; // first block in use
+      size_type numBlocks = myData.mySize == 0 ? 0 :
+                            ( myData.myOff + myData.mySize - 1 ) / dequeSize - first + 1;
+      for( size_type block = first; block < first + numBlocks; block++ )
+         newMap[ block & ( newMapSize - 1 ) ] = myData.map[ block & ( oldMapSize - 1 ) ];
+      for( size_type block = first; block < first + numBlocks; block++ )
+         myData.map[ block & ( oldMapSize - 1 ) ] = nullptr;
+
+      for( size_type i = 0; i < oldMapSize; i++ )
+         if( myData.map[ i ] != nullptr )
+            releaseBlock( myData.map[ i ] );
+      for( size_type i = 0; i < myData.numSpare; i++ )
+         releaseBlock( myData.spare[ i ] );
+      myData.numSpare = 0;
+
+      freeMap( myData.map, oldMapSize );
+      myData.map = newMap;
+      myData.mapSize = newMapSize;
+      myData.myOff &= newMapSize * dequeSize - 1;
+   }
+
+   // with auto trim on, halve the map while occupancy is below trimPercent,
+   // relinking the blocks once for the final size
+   void autoTrim()
+   {
+      if( myData.trimPercent > 0 && myData.mapSize > 8 &&
+          myData.mySize * 100 < myData.trimPercent * myData.mapSize * compDequeSize() )
+      {
+         size_type fit = fitMapSize();
+         size_type newMapSize = myData.mapSize;
+         while( newMapSize / 2 >= fit &&
+                myData.mySize * 100 < myData.trimPercent * newMapSize * compDequeSize() )
+            newMapSize /= 2;
+         if( newMapSize < myData.mapSize )
+            shrinkMap( newMapSize );
+      }
+   }
+
+   // move right's elements one by one to the same offsets in a map and blocks
+   // of this (empty) deque's own, then clear right. Each element is counted
+   // as soon as it is built, so a throw leaves this deque valid
+   void moveElements( deque &right )
+   {
+      size_type dequeSize = compDequeSize(); // elements per block (a power of 2)
+      if( right.myData.mySize > 0 )
+      {
+         myData.map = allocMap( right.myData.mapSize );
+         myData.mapSize = right.myData.mapSize;
+         myData.myOff = right.myData.myOff;
+         ++myData.numGrowths;
+         for( size_type off = myData.myOff; off < myData.myOff + right.myData.mySize; off++ )
+         {
+            MapPtr block = myData.map + getBlock( off );
+            if( *block == nullptr )
+               *block = allocBlock();
+            construct( &( *block )[ off % dequeSize ],
+                       std::move( right.myData.map[ right.getBlock( off ) ][ off % dequeSize ] ) );
+            ++myData.mySize;
+         }
       }
+      right.clear();
    }
 
-   size_type compDequeSize()
+   // elements per block (a power of 2)
+   static constexpr size_type compDequeSize()
    {
-      return sizeof( value_type ) <= 1 ? 16 : sizeof( value_type ) <= 2 ? 8 :
-             sizeof( value_type ) <= 4 ?  4 : sizeof( value_type ) <= 8 ? 2 : 1;
+      return ScaryVal::dequeSize;
    }
 
    ScaryVal myData;
+   BlockAlloc myAlloc; // allocates blocks and elements; rebound for the map
 };
 
 #endif
\ No newline at end of file
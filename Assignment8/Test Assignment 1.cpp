@@ -6,6 +6,11 @@ using std::endl;
 using std::time;
 
 #include <deque>
+#include <memory>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
 #include "Student ID - deque - assignment.h"
 
 template< typename T >
@@ -61,9 +66,27 @@ void testAssignment27();
 template< typename T >
 void testAssignment28();
 
+template< typename T >
+void testAssignment29();
+
+template< typename T >
+void testAssignment30();
+
+template< typename T >
+void testAssignment31();
+
+template< typename T >
+void testAssignment32();
+
 template< typename T >
 bool equal( std::deque< T > &deque1, deque< T > &deque2 );
 
+template< typename T >
+T** allocMap( size_t mapSize );
+
+template< typename T >
+T* allocBlock( size_t dequeSize );
+
 int main()
 {
    time_t t = time( nullptr );
@@ -105,6 +128,10 @@ void testAssignment()
    testAssignment27< T >();
 
    testAssignment28< T >();
+   testAssignment29< T >();
+   testAssignment30< T >();
+   testAssignment31< T >();
+   testAssignment32< T >();
 /*
 */
 }
@@ -143,8 +170,8 @@ void testAssignment1()
 
          *mapSize1 = mapSizeA;
          *mapSize2 = mapSizeA;
-         *map1 = new T*[ mapSizeA ]();
-         *map2 = new T*[ *mapSize2 ]();
+         *map1 = allocMap< T >( mapSizeA );
+         *map2 = allocMap< T >( *mapSize2 );
          *myOff1 = myOffA;
          *myOff2 = myOffA;
          *mySize1 = mySizeA;
@@ -152,8 +179,8 @@ void testAssignment1()
 
          for( size_t block = myOffA / dequeSize; block <= ( myOffA + mySizeA - 1 ) / dequeSize; block++ )
          {
-            ( *map1 )[ block % mapSizeA ] = new T[ dequeSize ];
-            ( *map2 )[ block % mapSizeA ] = new T[ dequeSize ];
+            ( *map1 )[ block % mapSizeA ] = allocBlock< T >( dequeSize );
+            ( *map2 )[ block % mapSizeA ] = allocBlock< T >( dequeSize );
          }
 
          for( size_t i = myOffA; i < myOffA + mySizeA; i++ )
@@ -181,8 +208,8 @@ void testAssignment1()
 
                *mapSize3 = mapSizeB;
                *mapSize4 = mapSizeB;
-               *map3 = new T*[ mapSizeB ]();
-               *map4 = new T*[ mapSizeB ]();
+               *map3 = allocMap< T >( mapSizeB );
+               *map4 = allocMap< T >( mapSizeB );
                *myOff3 = myOffB;
                *myOff4 = myOffB;
                *mySize3 = mySizeB;
@@ -190,8 +217,8 @@ void testAssignment1()
 
                for( size_t block = myOffB / dequeSize; block <= ( myOffB + mySizeB - 1 ) / dequeSize; block++ )
                {
-                  ( *map3 )[ block % mapSizeB ] = new T[ dequeSize ];
-                  ( *map4 )[ block % mapSizeB ] = new T[ dequeSize ];
+                  ( *map3 )[ block % mapSizeB ] = allocBlock< T >( dequeSize );
+                  ( *map4 )[ block % mapSizeB ] = allocBlock< T >( dequeSize );
                }
 
                for( size_t i = myOffB; i < myOffB + mySizeB; i++ )
@@ -244,8 +271,8 @@ void testAssignment2()
 
             *mapSize1 = mapSizeA;
             *mapSize2 = mapSizeA;
-            *map1 = new T*[ mapSizeA ]();
-            *map2 = new T*[ *mapSize2 ]();
+            *map1 = allocMap< T >( mapSizeA );
+            *map2 = allocMap< T >( *mapSize2 );
             *myOff1 = myOffA;
             *myOff2 = myOffA;
             *mySize1 = mySizeA;
@@ -253,8 +280,8 @@ void testAssignment2()
 
             for( size_t block = myOffA / dequeSize; block <= ( myOffA + mySizeA - 1 ) / dequeSize; block++ )
             {
-               ( *map1 )[ block % mapSizeA ] = new T[ dequeSize ];
-               ( *map2 )[ block % mapSizeA ] = new T[ dequeSize ];
+               ( *map1 )[ block % mapSizeA ] = allocBlock< T >( dequeSize );
+               ( *map2 )[ block % mapSizeA ] = allocBlock< T >( dequeSize );
             }
 
             for( size_t i = myOffA; i < myOffA + mySizeA; i++ )
@@ -280,8 +307,8 @@ void testAssignment2()
 
                *mapSize3 = mapSizeB;
                *mapSize4 = mapSizeB;
-               *map3 = new T*[ mapSizeB ]();
-               *map4 = new T*[ mapSizeB ]();
+               *map3 = allocMap< T >( mapSizeB );
+               *map4 = allocMap< T >( mapSizeB );
                *myOff3 = 0;
                *myOff4 = 0;
                *mySize3 = 0;
@@ -326,8 +353,8 @@ void testAssignment4()
 
       *mapSize1 = mapSizeA;
       *mapSize2 = mapSizeA;
-      *map1 = new T*[ mapSizeA ]();
-      *map2 = new T*[ *mapSize2 ]();
+      *map1 = allocMap< T >( mapSizeA );
+      *map2 = allocMap< T >( *mapSize2 );
       *myOff1 = 0;
       *myOff2 = 0;
       *mySize1 = 0;
@@ -349,8 +376,8 @@ void testAssignment4()
 
          *mapSize3 = mapSizeB;
          *mapSize4 = mapSizeB;
-         *map3 = new T*[ mapSizeB ]();
-         *map4 = new T*[ mapSizeB ]();
+         *map3 = allocMap< T >( mapSizeB );
+         *map4 = allocMap< T >( mapSizeB );
          *myOff3 = 0;
          *myOff4 = 0;
          *mySize3 = 0;
@@ -395,8 +422,8 @@ void testAssignment11()
 
             *mapSize1 = mapSizeA;
             *mapSize2 = mapSizeA;
-            *map1 = new T*[ mapSizeA ]();
-            *map2 = new T*[ *mapSize2 ]();
+            *map1 = allocMap< T >( mapSizeA );
+            *map2 = allocMap< T >( *mapSize2 );
             *myOff1 = myOffA;
             *myOff2 = myOffA;
             *mySize1 = mySizeA;
@@ -404,8 +431,8 @@ void testAssignment11()
 
             for( size_t block = myOffA / dequeSize; block <= ( myOffA + mySizeA - 1 ) / dequeSize; block++ )
             {
-               ( *map1 )[ block % mapSizeA ] = new T[ dequeSize ];
-               ( *map2 )[ block % mapSizeA ] = new T[ dequeSize ];
+               ( *map1 )[ block % mapSizeA ] = allocBlock< T >( dequeSize );
+               ( *map2 )[ block % mapSizeA ] = allocBlock< T >( dequeSize );
             }
 
             for( size_t i = myOffA; i < myOffA + mySizeA; i++ )
@@ -434,8 +461,8 @@ void testAssignment11()
 
                      *mapSize3 = mapSizeB;
                      *mapSize4 = mapSizeB;
-                     *map3 = new T*[ mapSizeB ]();
-                     *map4 = new T*[ mapSizeB ]();
+                     *map3 = allocMap< T >( mapSizeB );
+                     *map4 = allocMap< T >( mapSizeB );
                      *myOff3 = myOffB;
                      *myOff4 = myOffB;
                      *mySize3 = mySizeB;
@@ -443,8 +470,8 @@ void testAssignment11()
 
                      for( size_t block = myOffB / dequeSize; block <= ( myOffB + mySizeB - 1 ) / dequeSize; block++ )
                      {
-                        ( *map3 )[ block % mapSizeB ] = new T[ dequeSize ];
-                        ( *map4 )[ block % mapSizeB ] = new T[ dequeSize ];
+                        ( *map3 )[ block % mapSizeB ] = allocBlock< T >( dequeSize );
+                        ( *map4 )[ block % mapSizeB ] = allocBlock< T >( dequeSize );
                      }
 
                      for( size_t i = myOffB; i < myOffB + mySizeB; i++ )
@@ -499,8 +526,8 @@ void testAssignment13()
 
             *mapSize1 = mapSizeA;
             *mapSize2 = mapSizeA;
-            *map1 = new T*[ mapSizeA ]();
-            *map2 = new T*[ *mapSize2 ]();
+            *map1 = allocMap< T >( mapSizeA );
+            *map2 = allocMap< T >( *mapSize2 );
             *myOff1 = myOffA;
             *myOff2 = myOffA;
             *mySize1 = mySizeA;
@@ -508,8 +535,8 @@ void testAssignment13()
 
             for( size_t block = myOffA / dequeSize; block <= ( myOffA + mySizeA - 1 ) / dequeSize; block++ )
             {
-               ( *map1 )[ block % mapSizeA ] = new T[ dequeSize ];
-               ( *map2 )[ block % mapSizeA ] = new T[ dequeSize ];
+               ( *map1 )[ block % mapSizeA ] = allocBlock< T >( dequeSize );
+               ( *map2 )[ block % mapSizeA ] = allocBlock< T >( dequeSize );
             }
 
             for( size_t i = myOffA; i < myOffA + mySizeA; i++ )
@@ -538,8 +565,8 @@ void testAssignment13()
 
                      *mapSize3 = mapSizeB;
                      *mapSize4 = mapSizeB;
-                     *map3 = new T*[ mapSizeB ]();
-                     *map4 = new T*[ mapSizeB ]();
+                     *map3 = allocMap< T >( mapSizeB );
+                     *map4 = allocMap< T >( mapSizeB );
                      *myOff3 = myOffB;
                      *myOff4 = myOffB;
                      *mySize3 = mySizeB;
@@ -547,8 +574,8 @@ void testAssignment13()
 
                      for( size_t block = myOffB / dequeSize; block <= ( myOffB + mySizeB - 1 ) / dequeSize; block++ )
                      {
-                        ( *map3 )[ block % mapSizeB ] = new T[ dequeSize ];
-                        ( *map4 )[ block % mapSizeB ] = new T[ dequeSize ];
+                        ( *map3 )[ block % mapSizeB ] = allocBlock< T >( dequeSize );
+                        ( *map4 )[ block % mapSizeB ] = allocBlock< T >( dequeSize );
                      }
 
                      for( size_t i = myOffB; i < myOffB + mySizeB; i++ )
@@ -602,8 +629,8 @@ void testAssignment15()
 
             *mapSize1 = mapSizeA;
             *mapSize2 = mapSizeA;
-            *map1 = new T*[ mapSizeA ]();
-            *map2 = new T*[ *mapSize2 ]();
+            *map1 = allocMap< T >( mapSizeA );
+            *map2 = allocMap< T >( *mapSize2 );
             *myOff1 = myOffA;
             *myOff2 = myOffA;
             *mySize1 = mySizeA;
@@ -611,8 +638,8 @@ void testAssignment15()
 
             for( size_t block = myOffA / dequeSize; block <= ( myOffA + mySizeA - 1 ) / dequeSize; block++ )
             {
-               ( *map1 )[ block % mapSizeA ] = new T[ dequeSize ];
-               ( *map2 )[ block % mapSizeA ] = new T[ dequeSize ];
+               ( *map1 )[ block % mapSizeA ] = allocBlock< T >( dequeSize );
+               ( *map2 )[ block % mapSizeA ] = allocBlock< T >( dequeSize );
             }
 
             for( size_t i = myOffA; i < myOffA + mySizeA; i++ )
@@ -641,8 +668,8 @@ void testAssignment15()
 
                      *mapSize3 = mapSizeB;
                      *mapSize4 = mapSizeB;
-                     *map3 = new T*[ mapSizeB ]();
-                     *map4 = new T*[ mapSizeB ]();
+                     *map3 = allocMap< T >( mapSizeB );
+                     *map4 = allocMap< T >( mapSizeB );
                      *myOff3 = myOffB;
                      *myOff4 = myOffB;
                      *mySize3 = mySizeB;
@@ -650,8 +677,8 @@ void testAssignment15()
 
                      for( size_t block = myOffB / dequeSize; block <= ( myOffB + mySizeB - 1 ) / dequeSize; block++ )
                      {
-                        ( *map3 )[ block % mapSizeB ] = new T[ dequeSize ];
-                        ( *map4 )[ block % mapSizeB ] = new T[ dequeSize ];
+                        ( *map3 )[ block % mapSizeB ] = allocBlock< T >( dequeSize );
+                        ( *map4 )[ block % mapSizeB ] = allocBlock< T >( dequeSize );
                      }
 
                      for( size_t i = myOffB; i < myOffB + mySizeB; i++ )
@@ -705,8 +732,8 @@ void testAssignment16()
 
             *mapSize1 = mapSizeA;
             *mapSize2 = mapSizeA;
-            *map1 = new T*[ mapSizeA ]();
-            *map2 = new T*[ *mapSize2 ]();
+            *map1 = allocMap< T >( mapSizeA );
+            *map2 = allocMap< T >( *mapSize2 );
             *myOff1 = myOffA;
             *myOff2 = myOffA;
             *mySize1 = mySizeA;
@@ -714,8 +741,8 @@ void testAssignment16()
 
             for( size_t block = myOffA / dequeSize; block <= ( myOffA + mySizeA - 1 ) / dequeSize; block++ )
             {
-               ( *map1 )[ block % mapSizeA ] = new T[ dequeSize ];
-               ( *map2 )[ block % mapSizeA ] = new T[ dequeSize ];
+               ( *map1 )[ block % mapSizeA ] = allocBlock< T >( dequeSize );
+               ( *map2 )[ block % mapSizeA ] = allocBlock< T >( dequeSize );
             }
 
             for( size_t i = myOffA; i < myOffA + mySizeA; i++ )
@@ -744,8 +771,8 @@ void testAssignment16()
 
                      *mapSize3 = mapSizeB;
                      *mapSize4 = mapSizeB;
-                     *map3 = new T*[ mapSizeB ]();
-                     *map4 = new T*[ mapSizeB ]();
+                     *map3 = allocMap< T >( mapSizeB );
+                     *map4 = allocMap< T >( mapSizeB );
                      *myOff3 = myOffB;
                      *myOff4 = myOffB;
                      *mySize3 = mySizeB;
@@ -753,8 +780,8 @@ void testAssignment16()
 
                      for( size_t block = myOffB / dequeSize; block <= ( myOffB + mySizeB - 1 ) / dequeSize; block++ )
                      {
-                        ( *map3 )[ block % mapSizeB ] = new T[ dequeSize ];
-                        ( *map4 )[ block % mapSizeB ] = new T[ dequeSize ];
+                        ( *map3 )[ block % mapSizeB ] = allocBlock< T >( dequeSize );
+                        ( *map4 )[ block % mapSizeB ] = allocBlock< T >( dequeSize );
                      }
 
                      for( size_t i = myOffB; i < myOffB + mySizeB; i++ )
@@ -808,8 +835,8 @@ void testAssignment17()
 
             *mapSize1 = mapSizeA;
             *mapSize2 = mapSizeA;
-            *map1 = new T*[ mapSizeA ]();
-            *map2 = new T*[ *mapSize2 ]();
+            *map1 = allocMap< T >( mapSizeA );
+            *map2 = allocMap< T >( *mapSize2 );
             *myOff1 = myOffA;
             *myOff2 = myOffA;
             *mySize1 = mySizeA;
@@ -817,8 +844,8 @@ void testAssignment17()
 
             for( size_t block = myOffA / dequeSize; block <= ( myOffA + mySizeA - 1 ) / dequeSize; block++ )
             {
-               ( *map1 )[ block % mapSizeA ] = new T[ dequeSize ];
-               ( *map2 )[ block % mapSizeA ] = new T[ dequeSize ];
+               ( *map1 )[ block % mapSizeA ] = allocBlock< T >( dequeSize );
+               ( *map2 )[ block % mapSizeA ] = allocBlock< T >( dequeSize );
             }
 
             for( size_t i = myOffA; i < myOffA + mySizeA; i++ )
@@ -847,8 +874,8 @@ void testAssignment17()
 
                      *mapSize3 = mapSizeB;
                      *mapSize4 = mapSizeB;
-                     *map3 = new T*[ mapSizeB ]();
-                     *map4 = new T*[ mapSizeB ]();
+                     *map3 = allocMap< T >( mapSizeB );
+                     *map4 = allocMap< T >( mapSizeB );
                      *myOff3 = myOffB;
                      *myOff4 = myOffB;
                      *mySize3 = mySizeB;
@@ -856,8 +883,8 @@ void testAssignment17()
 
                      for( size_t block = myOffB / dequeSize; block <= ( myOffB + mySizeB - 1 ) / dequeSize; block++ )
                      {
-                        ( *map3 )[ block % mapSizeB ] = new T[ dequeSize ];
-                        ( *map4 )[ block % mapSizeB ] = new T[ dequeSize ];
+                        ( *map3 )[ block % mapSizeB ] = allocBlock< T >( dequeSize );
+                        ( *map4 )[ block % mapSizeB ] = allocBlock< T >( dequeSize );
                      }
 
                      for( size_t i = myOffB; i < myOffB + mySizeB; i++ )
@@ -921,8 +948,8 @@ void testAssignment18()
 
             *mapSize1 = mapSizeA;
             *mapSize2 = mapSizeA;
-            *map1 = new T*[ mapSizeA ]();
-            *map2 = new T*[ *mapSize2 ]();
+            *map1 = allocMap< T >( mapSizeA );
+            *map2 = allocMap< T >( *mapSize2 );
             *myOff1 = myOffA;
             *myOff2 = myOffA;
             *mySize1 = mySizeA;
@@ -930,8 +957,8 @@ void testAssignment18()
 
             for( size_t block = myOffA / dequeSize; block <= ( myOffA + mySizeA - 1 ) / dequeSize; block++ )
             {
-               ( *map1 )[ block % mapSizeA ] = new T[ dequeSize ];
-               ( *map2 )[ block % mapSizeA ] = new T[ dequeSize ];
+               ( *map1 )[ block % mapSizeA ] = allocBlock< T >( dequeSize );
+               ( *map2 )[ block % mapSizeA ] = allocBlock< T >( dequeSize );
             }
 
             for( size_t i = myOffA; i < myOffA + mySizeA; i++ )
@@ -960,8 +987,8 @@ void testAssignment18()
 
                      *mapSize3 = mapSizeB;
                      *mapSize4 = mapSizeB;
-                     *map3 = new T*[ mapSizeB ]();
-                     *map4 = new T*[ mapSizeB ]();
+                     *map3 = allocMap< T >( mapSizeB );
+                     *map4 = allocMap< T >( mapSizeB );
                      *myOff3 = myOffB;
                      *myOff4 = myOffB;
                      *mySize3 = mySizeB;
@@ -969,8 +996,8 @@ void testAssignment18()
 
                      for( size_t block = myOffB / dequeSize; block <= ( myOffB + mySizeB - 1 ) / dequeSize; block++ )
                      {
-                        ( *map3 )[ block % mapSizeB ] = new T[ dequeSize ];
-                        ( *map4 )[ block % mapSizeB ] = new T[ dequeSize ];
+                        ( *map3 )[ block % mapSizeB ] = allocBlock< T >( dequeSize );
+                        ( *map4 )[ block % mapSizeB ] = allocBlock< T >( dequeSize );
                      }
 
                      for( size_t i = myOffB; i < myOffB + mySizeB; i++ )
@@ -1029,8 +1056,8 @@ void testAssignment21()
 
             *mapSize1 = mapSizeA;
             *mapSize2 = mapSizeA;
-            *map1 = new T*[ mapSizeA ]();
-            *map2 = new T*[ *mapSize2 ]();
+            *map1 = allocMap< T >( mapSizeA );
+            *map2 = allocMap< T >( *mapSize2 );
             *myOff1 = myOffA;
             *myOff2 = myOffA;
             *mySize1 = mySizeA;
@@ -1038,8 +1065,8 @@ void testAssignment21()
 
             for( size_t block = myOffA / dequeSize; block <= ( myOffA + mySizeA - 1 ) / dequeSize; block++ )
             {
-               ( *map1 )[ block % mapSizeA ] = new T[ dequeSize ];
-               ( *map2 )[ block % mapSizeA ] = new T[ dequeSize ];
+               ( *map1 )[ block % mapSizeA ] = allocBlock< T >( dequeSize );
+               ( *map2 )[ block % mapSizeA ] = allocBlock< T >( dequeSize );
             }
 
             for( size_t i = myOffA; i < myOffA + mySizeA; i++ )
@@ -1068,8 +1095,8 @@ void testAssignment21()
 
                      *mapSize3 = mapSizeB;
                      *mapSize4 = mapSizeB;
-                     *map3 = new T*[ mapSizeB ]();
-                     *map4 = new T*[ mapSizeB ]();
+                     *map3 = allocMap< T >( mapSizeB );
+                     *map4 = allocMap< T >( mapSizeB );
                      *myOff3 = myOffB;
                      *myOff4 = myOffB;
                      *mySize3 = mySizeB;
@@ -1077,8 +1104,8 @@ void testAssignment21()
 
                      for( size_t block = myOffB / dequeSize; block <= ( myOffB + mySizeB - 1 ) / dequeSize; block++ )
                      {
-                        ( *map3 )[ block % mapSizeB ] = new T[ dequeSize ];
-                        ( *map4 )[ block % mapSizeB ] = new T[ dequeSize ];
+                        ( *map3 )[ block % mapSizeB ] = allocBlock< T >( dequeSize );
+                        ( *map4 )[ block % mapSizeB ] = allocBlock< T >( dequeSize );
                      }
 
                      for( size_t i = myOffB; i < myOffB + mySizeB; i++ )
@@ -1129,8 +1156,8 @@ void testAssignment23()
 
             *mapSize1 = mapSizeA;
             *mapSize2 = mapSizeA;
-            *map1 = new T * [ mapSizeA ]();
-            *map2 = new T * [ *mapSize2 ]();
+            *map1 = allocMap< T >( mapSizeA );
+            *map2 = allocMap< T >( *mapSize2 );
             *myOff1 = myOffA;
             *myOff2 = myOffA;
             *mySize1 = mySizeA;
@@ -1138,8 +1165,8 @@ void testAssignment23()
 
             for( size_t block = myOffA / dequeSize; block <= ( myOffA + mySizeA - 1 ) / dequeSize; block++ )
             {
-               ( *map1 )[ block % mapSizeA ] = new T[ dequeSize ];
-               ( *map2 )[ block % mapSizeA ] = new T[ dequeSize ];
+               ( *map1 )[ block % mapSizeA ] = allocBlock< T >( dequeSize );
+               ( *map2 )[ block % mapSizeA ] = allocBlock< T >( dequeSize );
             }
 
             for( size_t i = myOffA; i < myOffA + mySizeA; i++ )
@@ -1168,8 +1195,8 @@ void testAssignment23()
 
                      *mapSize3 = mapSizeB;
                      *mapSize4 = mapSizeB;
-                     *map3 = new T * [ mapSizeB ]();
-                     *map4 = new T * [ mapSizeB ]();
+                     *map3 = allocMap< T >( mapSizeB );
+                     *map4 = allocMap< T >( mapSizeB );
                      *myOff3 = myOffB;
                      *myOff4 = myOffB;
                      *mySize3 = mySizeB;
@@ -1177,8 +1204,8 @@ void testAssignment23()
 
                      for( size_t block = myOffB / dequeSize; block <= ( myOffB + mySizeB - 1 ) / dequeSize; block++ )
                      {
-                        ( *map3 )[ block % mapSizeB ] = new T[ dequeSize ];
-                        ( *map4 )[ block % mapSizeB ] = new T[ dequeSize ];
+                        ( *map3 )[ block % mapSizeB ] = allocBlock< T >( dequeSize );
+                        ( *map4 )[ block % mapSizeB ] = allocBlock< T >( dequeSize );
                      }
 
                      for( size_t i = myOffB; i < myOffB + mySizeB; i++ )
@@ -1233,8 +1260,8 @@ void testAssignment25()
 
             *mapSize1 = mapSizeA;
             *mapSize2 = mapSizeA;
-            *map1 = new T*[ mapSizeA ]();
-            *map2 = new T*[ *mapSize2 ]();
+            *map1 = allocMap< T >( mapSizeA );
+            *map2 = allocMap< T >( *mapSize2 );
             *myOff1 = myOffA;
             *myOff2 = myOffA;
             *mySize1 = mySizeA;
@@ -1242,8 +1269,8 @@ void testAssignment25()
 
             for( size_t block = myOffA / dequeSize; block <= ( myOffA + mySizeA - 1 ) / dequeSize; block++ )
             {
-               ( *map1 )[ block % mapSizeA ] = new T[ dequeSize ];
-               ( *map2 )[ block % mapSizeA ] = new T[ dequeSize ];
+               ( *map1 )[ block % mapSizeA ] = allocBlock< T >( dequeSize );
+               ( *map2 )[ block % mapSizeA ] = allocBlock< T >( dequeSize );
             }
 
             for( size_t i = myOffA; i < myOffA + mySizeA; i++ )
@@ -1272,8 +1299,8 @@ void testAssignment25()
 
                      *mapSize3 = mapSizeB;
                      *mapSize4 = mapSizeB;
-                     *map3 = new T*[ mapSizeB ]();
-                     *map4 = new T*[ mapSizeB ]();
+                     *map3 = allocMap< T >( mapSizeB );
+                     *map4 = allocMap< T >( mapSizeB );
                      *myOff3 = myOffB;
                      *myOff4 = myOffB;
                      *mySize3 = mySizeB;
@@ -1281,8 +1308,8 @@ void testAssignment25()
 
                      for( size_t block = myOffB / dequeSize; block <= ( myOffB + mySizeB - 1 ) / dequeSize; block++ )
                      {
-                        ( *map3 )[ block % mapSizeB ] = new T[ dequeSize ];
-                        ( *map4 )[ block % mapSizeB ] = new T[ dequeSize ];
+                        ( *map3 )[ block % mapSizeB ] = allocBlock< T >( dequeSize );
+                        ( *map4 )[ block % mapSizeB ] = allocBlock< T >( dequeSize );
                      }
 
                      for( size_t i = myOffB; i < myOffB + mySizeB; i++ )
@@ -1337,8 +1364,8 @@ void testAssignment26()
 
             *mapSize1 = mapSizeA;
             *mapSize2 = mapSizeA;
-            *map1 = new T*[ mapSizeA ]();
-            *map2 = new T*[ *mapSize2 ]();
+            *map1 = allocMap< T >( mapSizeA );
+            *map2 = allocMap< T >( *mapSize2 );
             *myOff1 = myOffA;
             *myOff2 = myOffA;
             *mySize1 = mySizeA;
@@ -1346,8 +1373,8 @@ void testAssignment26()
 
             for( size_t block = myOffA / dequeSize; block <= ( myOffA + mySizeA - 1 ) / dequeSize; block++ )
             {
-               ( *map1 )[ block % mapSizeA ] = new T[ dequeSize ];
-               ( *map2 )[ block % mapSizeA ] = new T[ dequeSize ];
+               ( *map1 )[ block % mapSizeA ] = allocBlock< T >( dequeSize );
+               ( *map2 )[ block % mapSizeA ] = allocBlock< T >( dequeSize );
             }
 
             for( size_t i = myOffA; i < myOffA + mySizeA; i++ )
@@ -1376,8 +1403,8 @@ void testAssignment26()
 
                      *mapSize3 = mapSizeB;
                      *mapSize4 = mapSizeB;
-                     *map3 = new T*[ mapSizeB ]();
-                     *map4 = new T*[ mapSizeB ]();
+                     *map3 = allocMap< T >( mapSizeB );
+                     *map4 = allocMap< T >( mapSizeB );
                      *myOff3 = myOffB;
                      *myOff4 = myOffB;
                      *mySize3 = mySizeB;
@@ -1385,8 +1412,8 @@ void testAssignment26()
 
                      for( size_t block = myOffB / dequeSize; block <= ( myOffB + mySizeB - 1 ) / dequeSize; block++ )
                      {
-                        ( *map3 )[ block % mapSizeB ] = new T[ dequeSize ];
-                        ( *map4 )[ block % mapSizeB ] = new T[ dequeSize ];
+                        ( *map3 )[ block % mapSizeB ] = allocBlock< T >( dequeSize );
+                        ( *map4 )[ block % mapSizeB ] = allocBlock< T >( dequeSize );
                      }
 
                      for( size_t i = myOffB; i < myOffB + mySizeB; i++ )
@@ -1446,8 +1473,8 @@ void testAssignment27()
 
             *mapSize1 = mapSizeA;
             *mapSize2 = mapSizeA;
-            *map1 = new T*[ mapSizeA ]();
-            *map2 = new T*[ *mapSize2 ]();
+            *map1 = allocMap< T >( mapSizeA );
+            *map2 = allocMap< T >( *mapSize2 );
             *myOff1 = myOffA;
             *myOff2 = myOffA;
             *mySize1 = mySizeA;
@@ -1455,8 +1482,8 @@ void testAssignment27()
 
             for( size_t block = myOffA / dequeSize; block <= ( myOffA + mySizeA - 1 ) / dequeSize; block++ )
             {
-               ( *map1 )[ block % mapSizeA ] = new T[ dequeSize ];
-               ( *map2 )[ block % mapSizeA ] = new T[ dequeSize ];
+               ( *map1 )[ block % mapSizeA ] = allocBlock< T >( dequeSize );
+               ( *map2 )[ block % mapSizeA ] = allocBlock< T >( dequeSize );
             }
 
             for( size_t i = myOffA; i < myOffA + mySizeA; i++ )
@@ -1485,8 +1512,8 @@ void testAssignment27()
 
                      *mapSize3 = mapSizeB;
                      *mapSize4 = mapSizeB;
-                     *map3 = new T*[ mapSizeB ]();
-                     *map4 = new T*[ mapSizeB ]();
+                     *map3 = allocMap< T >( mapSizeB );
+                     *map4 = allocMap< T >( mapSizeB );
                      *myOff3 = myOffB;
                      *myOff4 = myOffB;
                      *mySize3 = mySizeB;
@@ -1494,8 +1521,8 @@ void testAssignment27()
 
                      for( size_t block = myOffB / dequeSize; block <= ( myOffB + mySizeB - 1 ) / dequeSize; block++ )
                      {
-                        ( *map3 )[ block % mapSizeB ] = new T[ dequeSize ];
-                        ( *map4 )[ block % mapSizeB ] = new T[ dequeSize ];
+                        ( *map3 )[ block % mapSizeB ] = allocBlock< T >( dequeSize );
+                        ( *map4 )[ block % mapSizeB ] = allocBlock< T >( dequeSize );
                      }
 
                      for( size_t i = myOffB; i < myOffB + mySizeB; i++ )
@@ -1559,8 +1586,8 @@ void testAssignment28()
 
             *mapSize1 = mapSizeA;
             *mapSize2 = mapSizeA;
-            *map1 = new T*[ mapSizeA ]();
-            *map2 = new T*[ *mapSize2 ]();
+            *map1 = allocMap< T >( mapSizeA );
+            *map2 = allocMap< T >( *mapSize2 );
             *myOff1 = myOffA;
             *myOff2 = myOffA;
             *mySize1 = mySizeA;
@@ -1568,8 +1595,8 @@ void testAssignment28()
 
             for( size_t block = myOffA / dequeSize; block <= ( myOffA + mySizeA - 1 ) / dequeSize; block++ )
             {
-               ( *map1 )[ block % mapSizeA ] = new T[ dequeSize ];
-               ( *map2 )[ block % mapSizeA ] = new T[ dequeSize ];
+               ( *map1 )[ block % mapSizeA ] = allocBlock< T >( dequeSize );
+               ( *map2 )[ block % mapSizeA ] = allocBlock< T >( dequeSize );
             }
 
             for( size_t i = myOffA; i < myOffA + mySizeA; i++ )
@@ -1598,8 +1625,8 @@ void testAssignment28()
 
                      *mapSize3 = mapSizeB;
                      *mapSize4 = mapSizeB;
-                     *map3 = new T*[ mapSizeB ]();
-                     *map4 = new T*[ mapSizeB ]();
+                     *map3 = allocMap< T >( mapSizeB );
+                     *map4 = allocMap< T >( mapSizeB );
                      *myOff3 = myOffB;
                      *myOff4 = myOffB;
                      *mySize3 = mySizeB;
@@ -1607,8 +1634,8 @@ void testAssignment28()
 
                      for( size_t block = myOffB / dequeSize; block <= ( myOffB + mySizeB - 1 ) / dequeSize; block++ )
                      {
-                        ( *map3 )[ block % mapSizeB ] = new T[ dequeSize ];
-                        ( *map4 )[ block % mapSizeB ] = new T[ dequeSize ];
+                        ( *map3 )[ block % mapSizeB ] = allocBlock< T >( dequeSize );
+                        ( *map4 )[ block % mapSizeB ] = allocBlock< T >( dequeSize );
                      }
 
                      for( size_t i = myOffB; i < myOffB + mySizeB; i++ )
@@ -1640,6 +1667,230 @@ void testAssignment28()
    cout << endl;
 }
 
+// assign into a deque whose map already has every slot allocated; every
+// element must be copied and every block of the target must be reused in place
+template< typename T >
+void testAssignment29()
+{
+   size_t dequeSize = compDequeSize< T >(); // elements per block (a power of 2)
+
+   const size_t mapSizeA = 8;
+   size_t numErrors = 0;
+
+   for( size_t myOffA = 0; myOffA < dequeSize * mapSizeA; ++myOffA )
+      for( size_t mySizeA = 0; mySizeA <= dequeSize * ( mapSizeA - 1 ); ++mySizeA )
+      {
+         deque< T > deque1;
+         T ***map1 = reinterpret_cast< T *** > ( &deque1 );
+         size_t *mapSize1 = reinterpret_cast< size_t * >( &deque1 ) + 1;
+         size_t *myOff1 = reinterpret_cast< size_t * >( &deque1 ) + 2;
+         size_t *mySize1 = reinterpret_cast< size_t * >( &deque1 ) + 3;
+
+         *mapSize1 = mapSizeA;
+         *map1 = allocMap< T >( mapSizeA );
+         *myOff1 = myOffA;
+         *mySize1 = mySizeA;
+
+         if( mySizeA > 0 )
+            for( size_t block = myOffA / dequeSize; block <= ( myOffA + mySizeA - 1 ) / dequeSize; block++ )
+               ( *map1 )[ block % mapSizeA ] = allocBlock< T >( dequeSize );
+
+         for( size_t i = myOffA; i < myOffA + mySizeA; i++ )
+            ( *map1 )[ i % ( dequeSize * mapSizeA ) / dequeSize ][ i % dequeSize ] = static_cast< T >( 3 * i + 1 );
+
+         for( size_t myOffB = 0; myOffB < dequeSize * mapSizeA; myOffB += dequeSize / 2 + 1 )
+         {
+            deque< T > deque2;
+            T ***map2 = reinterpret_cast< T *** > ( &deque2 );
+            size_t *mapSize2 = reinterpret_cast< size_t * >( &deque2 ) + 1;
+            size_t *myOff2 = reinterpret_cast< size_t * >( &deque2 ) + 2;
+
+            *mapSize2 = mapSizeA;
+            *map2 = allocMap< T >( mapSizeA );
+            *myOff2 = myOffB;
+
+            T *blocks[ mapSizeA ];
+            for( size_t block = 0; block < mapSizeA; block++ )
+               blocks[ block ] = ( *map2 )[ block ] = allocBlock< T >( dequeSize );
+
+            deque2 = deque1;
+
+            bool same = deque2.size() == mySizeA;
+            size_t i = myOffA;
+            for( typename deque< T >::iterator it = deque2.begin(); same && it != deque2.end(); ++it, ++i )
+               same = *it == static_cast< T >( 3 * i + 1 );
+
+            for( size_t block = 0; same && block < mapSizeA; block++ )
+               same = ( *map2 )[ block ] == blocks[ block ];
+
+            if( !same )
+               numErrors++;
+         }
+      }
+
+   cout << "There are " << numErrors << " errors\n";
+   cout << endl;
+}
+
+// repopulate one deque again and again with assign, from a value, a vector
+// and a stream; once its map and blocks are large enough, nothing more is allocated
+template< typename T >
+void testAssignment30()
+{
+   size_t dequeSize = compDequeSize< T >(); // elements per block (a power of 2)
+   const size_t maxCount = dequeSize * 20;
+   size_t numErrors = 0;
+
+   deque< T > deque2;
+   deque2.assign( maxCount, static_cast< T >( 0 ) );
+   DequeMemoryStats stats = deque2.memory_stats();
+
+   for( int i = 0; i < 300; i++ )
+   {
+      size_t count = rand() % ( maxCount + 1 );
+      std::vector< T > vector1;
+      std::ostringstream stream;
+      for( size_t j = 0; j < count; j++ )
+      {
+         vector1.push_back( static_cast< T >( i % 3 == 0 ? i : rand() ) );
+         stream << static_cast< long long >( vector1.back() ) << ' ';
+      }
+
+      if( i % 3 == 0 )
+         deque2.assign( count, static_cast< T >( i ) );
+      else if( i % 3 == 1 )
+         deque2.assign( vector1.begin(), vector1.end() );
+      else
+      {
+         std::istringstream input( stream.str() );
+         deque2.assign( std::istream_iterator< long long >( input ), std::istream_iterator< long long >() );
+      }
+
+      size_t n = 0;
+      for( typename deque< T >::iterator it = deque2.begin(); it != deque2.end(); ++it, ++n )
+         if( n >= count || *it != vector1[ n ] )
+            numErrors++;
+      if( n != count || deque2.memory_stats().blocks != stats.blocks ||
+          deque2.memory_stats().growthEvents != stats.growthEvents )
+         numErrors++;
+   }
+
+   deque2.assign( { static_cast< T >( 1 ), static_cast< T >( 2 ), static_cast< T >( 3 ) } );
+   if( deque2.end() - deque2.begin() != 3 || *deque2.begin() != static_cast< T >( 1 ) )
+      numErrors++;
+
+   cout << "There are " << numErrors << " errors\n";
+   cout << endl;
+}
+
+// assign copies of one of the deque's own elements, to a smaller, an equal
+// and a larger size; the element must be read before anything is destroyed
+template< typename T >
+void testAssignment31()
+{
+   size_t dequeSize = compDequeSize< T >(); // elements per block (a power of 2)
+   size_t numErrors = 0;
+
+   for( int i = 0; i < 300; i++ )
+   {
+      size_t oldCount = 1 + rand() % ( dequeSize * 12 );
+      size_t newCount = rand() % ( dequeSize * 30 );
+      size_t pos = rand() % oldCount;
+
+      deque< T > deque2;
+      deque< std::string > deque3;
+      deque2.assign( oldCount, static_cast< T >( 0 ) );
+      deque3.assign( oldCount, std::string() );
+      size_t j = 0;
+      for( typename deque< T >::iterator it = deque2.begin(); it != deque2.end(); ++it, ++j )
+         *it = static_cast< T >( j );
+      j = 0;
+      for( typename deque< std::string >::iterator it = deque3.begin(); it != deque3.end(); ++it, ++j )
+         *it = std::to_string( j ) + std::string( 40, 'x' ); // too long to be stored inline
+
+      deque2.assign( newCount, *( deque2.begin() + static_cast< ptrdiff_t >( pos ) ) );
+      deque3.assign( newCount, *( deque3.begin() + static_cast< ptrdiff_t >( pos ) ) );
+
+      if( static_cast< size_t >( deque2.end() - deque2.begin() ) != newCount ||
+          static_cast< size_t >( deque3.end() - deque3.begin() ) != newCount )
+         numErrors++;
+      for( typename deque< T >::iterator it = deque2.begin(); it != deque2.end(); ++it )
+         if( *it != static_cast< T >( pos ) )
+            numErrors++;
+      for( typename deque< std::string >::iterator it = deque3.begin(); it != deque3.end(); ++it )
+         if( *it != std::to_string( pos ) + std::string( 40, 'x' ) )
+            numErrors++;
+   }
+
+   cout << "There are " << numErrors << " errors\n";
+   cout << endl;
+}
+
+// with parallel copy switched on for every size, assigning must put each
+// worker's run of blocks where a single-threaded copy would, whatever the
+// offsets of the source and the destination
+template< typename T >
+void testAssignment32()
+{
+   size_t dequeSize = compDequeSize< T >(); // elements per block (a power of 2)
+   size_t numErrors = 0;
+
+   unsigned threads = DequeParallel::threads;
+   size_t threshold = DequeParallel::threshold;
+   DequeParallel::threads = 4;
+   DequeParallel::threshold = 1;
+
+   for( int i = 0; i < 500; i++ )
+   {
+      size_t mapSize = 8 << ( rand() % 3 );
+      size_t myOff = rand() % ( dequeSize * mapSize );
+      size_t mySize = 1 + rand() % ( dequeSize * ( mapSize - 1 ) );
+
+      deque< T > deque1;
+      T ***map1 = reinterpret_cast< T *** > ( &deque1 );
+      size_t *mapSize1 = reinterpret_cast< size_t * >( &deque1 ) + 1;
+      size_t *myOff1 = reinterpret_cast< size_t * >( &deque1 ) + 2;
+      size_t *mySize1 = reinterpret_cast< size_t * >( &deque1 ) + 3;
+      *mapSize1 = mapSize;
+      *map1 = allocMap< T >( mapSize );
+      *myOff1 = myOff;
+      *mySize1 = mySize;
+      for( size_t block = myOff / dequeSize; block <= ( myOff + mySize - 1 ) / dequeSize; block++ )
+         if( ( *map1 )[ block % mapSize ] == nullptr )
+            ( *map1 )[ block % mapSize ] = allocBlock< T >( dequeSize );
+      for( size_t j = myOff; j < myOff + mySize; j++ )
+         ( *map1 )[ j % ( dequeSize * mapSize ) / dequeSize ][ j % dequeSize ] = static_cast< T >( j );
+
+      deque< T > deque2;
+      deque2.assign( rand() % ( dequeSize * 60 ), static_cast< T >( 0 ) );
+
+      deque2 = deque1;
+
+      bool same = deque2.size() == mySize;
+      const deque< T > &constDeque = deque2;
+      size_t j = myOff;
+      for( typename deque< T >::const_iterator it = constDeque.begin(); same && it != constDeque.end(); ++it, ++j )
+         same = *it == static_cast< T >( j );
+      if( !same )
+         numErrors++;
+   }
+
+   // with no threshold at all, copying an empty deque must not be split
+   DequeParallel::threshold = 0;
+   deque< T > deque4;
+   deque< T > deque5;
+   deque5.assign( 3, static_cast< T >( 1 ) );
+   deque5 = deque4;
+   if( deque5.size() != 0 )
+      numErrors++;
+
+   DequeParallel::threads = threads;
+   DequeParallel::threshold = threshold;
+
+   cout << "There are " << numErrors << " errors\n";
+   cout << endl;
+}
+
 template< typename T >
 bool equal( std::deque< T > &deque1, deque< T > &deque2 )
 {
@@ -1700,4 +1951,22 @@ bool equal( std::deque< T > &deque1, deque< T > &deque2 )
    }
 
    return true;
+}
+
+// allocate a map of mapSize null block pointers with std::allocator, as the
+// deque does, so the deque may release a map injected into it
+template< typename T >
+T** allocMap( size_t mapSize )
+{
+   T** map = std::allocator< T* >().allocate( mapSize );
+   for( size_t i = 0; i < mapSize; i++ )
+      map[ i ] = nullptr;
+   return map;
+}
+
+// allocate a block of dequeSize elements with std::allocator, as the deque does
+template< typename T >
+T* allocBlock( size_t dequeSize )
+{
+   return std::allocator< T >().allocate( dequeSize );
 }
\ No newline at end of file
@@ -6,6 +6,7 @@ using std::endl;
 using std::time;
 
 #include <deque>
+#include <memory>
 #include "Student ID - deque - assignment2.h"
 
 template< typename T >
@@ -67,9 +68,18 @@ void testAssignment27();
 template< typename T >
 void testAssignment28();
 
+template< typename T >
+void testAssignment29();
+
 template< typename T >
 bool equal( std::deque< T > &deque1, deque< T > &deque2 );
 
+template< typename T >
+T** allocMap( size_t mapSize );
+
+template< typename T >
+T* allocBlock( size_t dequeSize );
+
 int main()
 {
 /**/
@@ -116,6 +126,7 @@ void testAssignment()
    testAssignment26< T >();
    testAssignment27< T >();
    testAssignment28< T >();
+   testAssignment29< T >();
 /*
 */
    cout << time( nullptr ) - t << " seconds\n\n";
@@ -148,12 +159,12 @@ void testAssignment1()
             size_t *mySize1 = reinterpret_cast< size_t * >( &deque1 ) + 3;
 
             *mapSize1 = mapSizeA;
-            *map1 = new T * [ mapSizeA ]();
+            *map1 = allocMap< T >( mapSizeA );
             *myOff1 = myOffA;
             *mySize1 = mySizeA;
 
             for( size_t block = myOffA / dequeSize; block <= ( myOffA + mySizeA - 1 ) / dequeSize; block++ )
-               ( *map1 )[ block % mapSizeA ] = new T[ dequeSize ];
+               ( *map1 )[ block % mapSizeA ] = allocBlock< T >( dequeSize );
 
             for( size_t i = myOffA; i < myOffA + mySizeA; i++ )
             {
@@ -173,12 +184,12 @@ void testAssignment1()
                      size_t *mySize2 = reinterpret_cast< size_t * >( &deque2 ) + 3;
 
                      *mapSize2 = mapSizeB;
-                     *map2 = new T * [ mapSizeB ]();
+                     *map2 = allocMap< T >( mapSizeB );
                      *myOff2 = myOffB;
                      *mySize2 = mySizeB;
 
                      for( size_t block = myOffB / dequeSize; block <= ( myOffB + mySizeB - 1 ) / dequeSize; block++ )
-                        ( *map2 )[ block % mapSizeB ] = new T[ dequeSize ];
+                        ( *map2 )[ block % mapSizeB ] = allocBlock< T >( dequeSize );
 
                      for( size_t i = myOffB; i < myOffB + mySizeB; i++ )
                      {
@@ -241,12 +252,12 @@ void testAssignment2()
             size_t *mySize1 = reinterpret_cast< size_t * >( &deque1 ) + 3;
 
             *mapSize1 = mapSizeA;
-            *map1 = new T * [ mapSizeA ]();
+            *map1 = allocMap< T >( mapSizeA );
             *myOff1 = myOffA;
             *mySize1 = mySizeA;
 
             for( size_t block = myOffA / dequeSize; block <= ( myOffA + mySizeA - 1 ) / dequeSize; block++ )
-               ( *map1 )[ block % mapSizeA ] = new T[ dequeSize ];
+               ( *map1 )[ block % mapSizeA ] = allocBlock< T >( dequeSize );
 
             for( size_t i = myOffA; i < myOffA + mySizeA; i++ )
             {
@@ -266,12 +277,12 @@ void testAssignment2()
                      size_t *mySize2 = reinterpret_cast< size_t * >( &deque2 ) + 3;
 
                      *mapSize2 = mapSizeB;
-                     *map2 = new T * [ mapSizeB ]();
+                     *map2 = allocMap< T >( mapSizeB );
                      *myOff2 = myOffB;
                      *mySize2 = mySizeB;
 
                      for( size_t block = myOffB / dequeSize; block <= ( myOffB + mySizeB - 1 ) / dequeSize; block++ )
-                        ( *map2 )[ block % mapSizeB ] = new T[ dequeSize ];
+                        ( *map2 )[ block % mapSizeB ] = allocBlock< T >( dequeSize );
 
                      for( size_t i = myOffB; i < myOffB + mySizeB; i++ )
                      {
@@ -345,12 +356,12 @@ void testAssignment3()
             size_t *mySize1 = reinterpret_cast< size_t * >( &deque1 ) + 3;
 
             *mapSize1 = mapSizeA;
-            *map1 = new T * [ mapSizeA ]();
+            *map1 = allocMap< T >( mapSizeA );
             *myOff1 = myOffA;
             *mySize1 = mySizeA;
 
             for( size_t block = myOffA / dequeSize; block <= ( myOffA + mySizeA - 1 ) / dequeSize; block++ )
-               ( *map1 )[ block % mapSizeA ] = new T[ dequeSize ];
+               ( *map1 )[ block % mapSizeA ] = allocBlock< T >( dequeSize );
 
             for( size_t i = myOffA; i < myOffA + mySizeA; i++ )
             {
@@ -370,12 +381,12 @@ void testAssignment3()
                      size_t *mySize2 = reinterpret_cast< size_t * >( &deque2 ) + 3;
 
                      *mapSize2 = mapSizeB;
-                     *map2 = new T * [ mapSizeB ]();
+                     *map2 = allocMap< T >( mapSizeB );
                      *myOff2 = myOffB;
                      *mySize2 = mySizeB;
 
                      for( size_t block = myOffB / dequeSize; block <= ( myOffB + mySizeB - 1 ) / dequeSize; block++ )
-                        ( *map2 )[ block % mapSizeB ] = new T[ dequeSize ];
+                        ( *map2 )[ block % mapSizeB ] = allocBlock< T >( dequeSize );
 
                      for( size_t i = myOffB; i < myOffB + mySizeB; i++ )
                      {
@@ -456,12 +467,12 @@ void testAssignment4()
             size_t *mySize1 = reinterpret_cast< size_t * >( &deque1 ) + 3;
 
             *mapSize1 = mapSizeA;
-            *map1 = new T * [ mapSizeA ]();
+            *map1 = allocMap< T >( mapSizeA );
             *myOff1 = myOffA;
             *mySize1 = mySizeA;
 
             for( size_t block = myOffA / dequeSize; block <= ( myOffA + mySizeA - 1 ) / dequeSize; block++ )
-               ( *map1 )[ block % mapSizeA ] = new T[ dequeSize ];
+               ( *map1 )[ block % mapSizeA ] = allocBlock< T >( dequeSize );
 
             for( size_t i = myOffA; i < myOffA + mySizeA; i++ )
             {
@@ -481,12 +492,12 @@ void testAssignment4()
                      size_t *mySize2 = reinterpret_cast< size_t * >( &deque2 ) + 3;
 
                      *mapSize2 = mapSizeB;
-                     *map2 = new T * [ mapSizeB ]();
+                     *map2 = allocMap< T >( mapSizeB );
                      *myOff2 = myOffB;
                      *mySize2 = mySizeB;
 
                      for( size_t block = myOffB / dequeSize; block <= ( myOffB + mySizeB - 1 ) / dequeSize; block++ )
-                        ( *map2 )[ block % mapSizeB ] = new T[ dequeSize ];
+                        ( *map2 )[ block % mapSizeB ] = allocBlock< T >( dequeSize );
 
                      for( size_t i = myOffB; i < myOffB + mySizeB; i++ )
                      {
@@ -549,12 +560,12 @@ void testAssignment5()
             size_t *mySize1 = reinterpret_cast< size_t * >( &deque1 ) + 3;
 
             *mapSize1 = mapSizeA;
-            *map1 = new T * [ mapSizeA ]();
+            *map1 = allocMap< T >( mapSizeA );
             *myOff1 = myOffA;
             *mySize1 = mySizeA;
 
             for( size_t block = myOffA / dequeSize; block <= ( myOffA + mySizeA - 1 ) / dequeSize; block++ )
-               ( *map1 )[ block % mapSizeA ] = new T[ dequeSize ];
+               ( *map1 )[ block % mapSizeA ] = allocBlock< T >( dequeSize );
 
             for( size_t i = myOffA; i < myOffA + mySizeA; i++ )
             {
@@ -574,12 +585,12 @@ void testAssignment5()
                      size_t *mySize2 = reinterpret_cast< size_t * >( &deque2 ) + 3;
 
                      *mapSize2 = mapSizeB;
-                     *map2 = new T * [ mapSizeB ]();
+                     *map2 = allocMap< T >( mapSizeB );
                      *myOff2 = myOffB;
                      *mySize2 = mySizeB;
 
                      for( size_t block = myOffB / dequeSize; block <= ( myOffB + mySizeB - 1 ) / dequeSize; block++ )
-                        ( *map2 )[ block % mapSizeB ] = new T[ dequeSize ];
+                        ( *map2 )[ block % mapSizeB ] = allocBlock< T >( dequeSize );
 
                      for( size_t i = myOffB; i < myOffB + mySizeB; i++ )
                      {
@@ -650,12 +661,12 @@ void testAssignment11()
             size_t *mySize1 = reinterpret_cast< size_t * >( &deque1 ) + 3;
 
             *mapSize1 = mapSizeA;
-            *map1 = new T * [ mapSizeA ]();
+            *map1 = allocMap< T >( mapSizeA );
             *myOff1 = myOffA;
             *mySize1 = mySizeA;
 
             for( size_t block = myOffA / dequeSize; block <= ( myOffA + mySizeA - 1 ) / dequeSize; block++ )
-               ( *map1 )[ block % mapSizeA ] = new T[ dequeSize ];
+               ( *map1 )[ block % mapSizeA ] = allocBlock< T >( dequeSize );
 
             for( size_t i = myOffA; i < myOffA + mySizeA; i++ )
             {
@@ -675,12 +686,12 @@ void testAssignment11()
                      size_t *mySize2 = reinterpret_cast< size_t * >( &deque2 ) + 3;
 
                      *mapSize2 = mapSizeB;
-                     *map2 = new T * [ mapSizeB ]();
+                     *map2 = allocMap< T >( mapSizeB );
                      *myOff2 = myOffB;
                      *mySize2 = mySizeB;
 
                      for( size_t block = myOffB / dequeSize; block <= ( myOffB + mySizeB - 1 ) / dequeSize; block++ )
-                        ( *map2 )[ block % mapSizeB ] = new T[ dequeSize ];
+                        ( *map2 )[ block % mapSizeB ] = allocBlock< T >( dequeSize );
 
                      for( size_t i = myOffB; i < myOffB + mySizeB; i++ )
                      {
@@ -743,12 +754,12 @@ void testAssignment13()
             size_t *mySize1 = reinterpret_cast< size_t * >( &deque1 ) + 3;
 
             *mapSize1 = mapSizeA;
-            *map1 = new T * [ mapSizeA ]();
+            *map1 = allocMap< T >( mapSizeA );
             *myOff1 = myOffA;
             *mySize1 = mySizeA;
 
             for( size_t block = myOffA / dequeSize; block <= ( myOffA + mySizeA - 1 ) / dequeSize; block++ )
-               ( *map1 )[ block % mapSizeA ] = new T[ dequeSize ];
+               ( *map1 )[ block % mapSizeA ] = allocBlock< T >( dequeSize );
 
             for( size_t i = myOffA; i < myOffA + mySizeA; i++ )
             {
@@ -768,12 +779,12 @@ void testAssignment13()
                      size_t *mySize2 = reinterpret_cast< size_t * >( &deque2 ) + 3;
 
                      *mapSize2 = mapSizeB;
-                     *map2 = new T * [ mapSizeB ]();
+                     *map2 = allocMap< T >( mapSizeB );
                      *myOff2 = myOffB;
                      *mySize2 = mySizeB;
 
                      for( size_t block = myOffB / dequeSize; block <= ( myOffB + mySizeB - 1 ) / dequeSize; block++ )
-                        ( *map2 )[ block % mapSizeB ] = new T[ dequeSize ];
+                        ( *map2 )[ block % mapSizeB ] = allocBlock< T >( dequeSize );
 
                      for( size_t i = myOffB; i < myOffB + mySizeB; i++ )
                      {
@@ -835,12 +846,12 @@ void testAssignment15()
             size_t *mySize1 = reinterpret_cast< size_t * >( &deque1 ) + 3;
 
             *mapSize1 = mapSizeA;
-            *map1 = new T * [ mapSizeA ]();
+            *map1 = allocMap< T >( mapSizeA );
             *myOff1 = myOffA;
             *mySize1 = mySizeA;
 
             for( size_t block = myOffA / dequeSize; block <= ( myOffA + mySizeA - 1 ) / dequeSize; block++ )
-               ( *map1 )[ block % mapSizeA ] = new T[ dequeSize ];
+               ( *map1 )[ block % mapSizeA ] = allocBlock< T >( dequeSize );
 
             for( size_t i = myOffA; i < myOffA + mySizeA; i++ )
             {
@@ -860,12 +871,12 @@ void testAssignment15()
                     size_t *mySize2 = reinterpret_cast< size_t * >( &deque2 ) + 3;
 
                     *mapSize2 = mapSizeB;
-                    *map2 = new T * [ mapSizeB ]();
+                    *map2 = allocMap< T >( mapSizeB );
                     *myOff2 = myOffB;
                     *mySize2 = mySizeB;
 
                     for( size_t block = myOffB / dequeSize; block <= ( myOffB + mySizeB - 1 ) / dequeSize; block++ )
-                       ( *map2 )[ block % mapSizeB ] = new T[ dequeSize ];
+                       ( *map2 )[ block % mapSizeB ] = allocBlock< T >( dequeSize );
 
                     for( size_t i = myOffB; i < myOffB + mySizeB; i++ )
                     {
@@ -936,12 +947,12 @@ void testAssignment16()
             size_t *mySize1 = reinterpret_cast< size_t * >( &deque1 ) + 3;
 
             *mapSize1 = mapSizeA;
-            *map1 = new T * [ mapSizeA ]();
+            *map1 = allocMap< T >( mapSizeA );
             *myOff1 = myOffA;
             *mySize1 = mySizeA;
 
             for( size_t block = myOffA / dequeSize; block <= ( myOffA + mySizeA - 1 ) / dequeSize; block++ )
-               ( *map1 )[ block % mapSizeA ] = new T[ dequeSize ];
+               ( *map1 )[ block % mapSizeA ] = allocBlock< T >( dequeSize );
 
             for( size_t i = myOffA; i < myOffA + mySizeA; i++ )
             {
@@ -961,12 +972,12 @@ void testAssignment16()
                      size_t *mySize2 = reinterpret_cast< size_t * >( &deque2 ) + 3;
 
                      *mapSize2 = mapSizeB;
-                     *map2 = new T * [ mapSizeB ]();
+                     *map2 = allocMap< T >( mapSizeB );
                      *myOff2 = myOffB;
                      *mySize2 = mySizeB;
 
                      for( size_t block = myOffB / dequeSize; block <= ( myOffB + mySizeB - 1 ) / dequeSize; block++ )
-                        ( *map2 )[ block % mapSizeB ] = new T[ dequeSize ];
+                        ( *map2 )[ block % mapSizeB ] = allocBlock< T >( dequeSize );
 
                      for( size_t i = myOffB; i < myOffB + mySizeB; i++ )
                      {
@@ -1037,12 +1048,12 @@ void testAssignment17()
             size_t *mySize1 = reinterpret_cast< size_t * >( &deque1 ) + 3;
 
             *mapSize1 = mapSizeA;
-            *map1 = new T * [ mapSizeA ]();
+            *map1 = allocMap< T >( mapSizeA );
             *myOff1 = myOffA;
             *mySize1 = mySizeA;
 
             for( size_t block = myOffA / dequeSize; block <= ( myOffA + mySizeA - 1 ) / dequeSize; block++ )
-               ( *map1 )[ block % mapSizeA ] = new T[ dequeSize ];
+               ( *map1 )[ block % mapSizeA ] = allocBlock< T >( dequeSize );
 
             for( size_t i = myOffA; i < myOffA + mySizeA; i++ )
             {
@@ -1062,12 +1073,12 @@ void testAssignment17()
                      size_t *mySize2 = reinterpret_cast< size_t * >( &deque2 ) + 3;
 
                      *mapSize2 = mapSizeB;
-                     *map2 = new T * [ mapSizeB ]();
+                     *map2 = allocMap< T >( mapSizeB );
                      *myOff2 = myOffB;
                      *mySize2 = mySizeB;
 
                      for( size_t block = myOffB / dequeSize; block <= ( myOffB + mySizeB - 1 ) / dequeSize; block++ )
-                        ( *map2 )[ block % mapSizeB ] = new T[ dequeSize ];
+                        ( *map2 )[ block % mapSizeB ] = allocBlock< T >( dequeSize );
 
                      for( size_t i = myOffB; i < myOffB + mySizeB; i++ )
                      {
@@ -1143,12 +1154,12 @@ void testAssignment18()
             size_t *mySize1 = reinterpret_cast< size_t * >( &deque1 ) + 3;
 
             *mapSize1 = mapSizeA;
-            *map1 = new T * [ mapSizeA ]();
+            *map1 = allocMap< T >( mapSizeA );
             *myOff1 = myOffA;
             *mySize1 = mySizeA;
 
             for( size_t block = myOffA / dequeSize; block <= ( myOffA + mySizeA - 1 ) / dequeSize; block++ )
-               ( *map1 )[ block % mapSizeA ] = new T[ dequeSize ];
+               ( *map1 )[ block % mapSizeA ] = allocBlock< T >( dequeSize );
 
             for( size_t i = myOffA; i < myOffA + mySizeA; i++ )
             {
@@ -1168,12 +1179,12 @@ void testAssignment18()
                      size_t *mySize2 = reinterpret_cast< size_t * >( &deque2 ) + 3;
 
                      *mapSize2 = mapSizeB;
-                     *map2 = new T * [ mapSizeB ]();
+                     *map2 = allocMap< T >( mapSizeB );
                      *myOff2 = myOffB;
                      *mySize2 = mySizeB;
 
                      for( size_t block = myOffB / dequeSize; block <= ( myOffB + mySizeB - 1 ) / dequeSize; block++ )
-                        ( *map2 )[ block % mapSizeB ] = new T[ dequeSize ];
+                        ( *map2 )[ block % mapSizeB ] = allocBlock< T >( dequeSize );
 
                      for( size_t i = myOffB; i < myOffB + mySizeB; i++ )
                      {
@@ -1243,12 +1254,12 @@ void testAssignment21()
             size_t *mySize1 = reinterpret_cast< size_t * >( &deque1 ) + 3;
 
             *mapSize1 = mapSizeA;
-            *map1 = new T * [ mapSizeA ]();
+            *map1 = allocMap< T >( mapSizeA );
             *myOff1 = myOffA;
             *mySize1 = mySizeA;
 
             for( size_t block = myOffA / dequeSize; block <= ( myOffA + mySizeA - 1 ) / dequeSize; block++ )
-               ( *map1 )[ block % mapSizeA ] = new T[ dequeSize ];
+               ( *map1 )[ block % mapSizeA ] = allocBlock< T >( dequeSize );
 
             for( size_t i = myOffA; i < myOffA + mySizeA; i++ )
             {
@@ -1268,12 +1279,12 @@ void testAssignment21()
                      size_t *mySize2 = reinterpret_cast< size_t * >( &deque2 ) + 3;
 
                      *mapSize2 = mapSizeB;
-                     *map2 = new T * [ mapSizeB ]();
+                     *map2 = allocMap< T >( mapSizeB );
                      *myOff2 = myOffB;
                      *mySize2 = mySizeB;
 
                      for( size_t block = myOffB / dequeSize; block <= ( myOffB + mySizeB - 1 ) / dequeSize; block++ )
-                        ( *map2 )[ block % mapSizeB ] = new T[ dequeSize ];
+                        ( *map2 )[ block % mapSizeB ] = allocBlock< T >( dequeSize );
 
                      for( size_t i = myOffB; i < myOffB + mySizeB; i++ )
                      {
@@ -1335,12 +1346,12 @@ void testAssignment23()
             size_t *mySize1 = reinterpret_cast< size_t * >( &deque1 ) + 3;
 
             *mapSize1 = mapSizeA;
-            *map1 = new T * [ mapSizeA ]();
+            *map1 = allocMap< T >( mapSizeA );
             *myOff1 = myOffA;
             *mySize1 = mySizeA;
 
             for( size_t block = myOffA / dequeSize; block <= ( myOffA + mySizeA - 1 ) / dequeSize; block++ )
-               ( *map1 )[ block % mapSizeA ] = new T[ dequeSize ];
+               ( *map1 )[ block % mapSizeA ] = allocBlock< T >( dequeSize );
 
             for( size_t i = myOffA; i < myOffA + mySizeA; i++ )
             {
@@ -1360,12 +1371,12 @@ void testAssignment23()
                      size_t *mySize2 = reinterpret_cast< size_t * >( &deque2 ) + 3;
 
                      *mapSize2 = mapSizeB;
-                     *map2 = new T * [ mapSizeB ]();
+                     *map2 = allocMap< T >( mapSizeB );
                      *myOff2 = myOffB;
                      *mySize2 = mySizeB;
 
                      for( size_t block = myOffB / dequeSize; block <= ( myOffB + mySizeB - 1 ) / dequeSize; block++ )
-                        ( *map2 )[ block % mapSizeB ] = new T[ dequeSize ];
+                        ( *map2 )[ block % mapSizeB ] = allocBlock< T >( dequeSize );
 
                      for( size_t i = myOffB; i < myOffB + mySizeB; i++ )
                      {
@@ -1428,12 +1439,12 @@ void testAssignment25()
             size_t *mySize1 = reinterpret_cast< size_t * >( &deque1 ) + 3;
 
             *mapSize1 = mapSizeA;
-            *map1 = new T * [ mapSizeA ]();
+            *map1 = allocMap< T >( mapSizeA );
             *myOff1 = myOffA;
             *mySize1 = mySizeA;
 
             for( size_t block = myOffA / dequeSize; block <= ( myOffA + mySizeA - 1 ) / dequeSize; block++ )
-               ( *map1 )[ block % mapSizeA ] = new T[ dequeSize ];
+               ( *map1 )[ block % mapSizeA ] = allocBlock< T >( dequeSize );
 
             for( size_t i = myOffA; i < myOffA + mySizeA; i++ )
             {
@@ -1453,12 +1464,12 @@ void testAssignment25()
                      size_t *mySize2 = reinterpret_cast< size_t * >( &deque2 ) + 3;
 
                      *mapSize2 = mapSizeB;
-                     *map2 = new T * [ mapSizeB ]();
+                     *map2 = allocMap< T >( mapSizeB );
                      *myOff2 = myOffB;
                      *mySize2 = mySizeB;
 
                      for( size_t block = myOffB / dequeSize; block <= ( myOffB + mySizeB - 1 ) / dequeSize; block++ )
-                        ( *map2 )[ block % mapSizeB ] = new T[ dequeSize ];
+                        ( *map2 )[ block % mapSizeB ] = allocBlock< T >( dequeSize );
 
                      for( size_t i = myOffB; i < myOffB + mySizeB; i++ )
                      {
@@ -1525,12 +1536,12 @@ void testAssignment26()
             size_t *mySize1 = reinterpret_cast< size_t * >( &deque1 ) + 3;
 
             *mapSize1 = mapSizeA;
-            *map1 = new T * [ mapSizeA ]();
+            *map1 = allocMap< T >( mapSizeA );
             *myOff1 = myOffA;
             *mySize1 = mySizeA;
 
             for( size_t block = myOffA / dequeSize; block <= ( myOffA + mySizeA - 1 ) / dequeSize; block++ )
-               ( *map1 )[ block % mapSizeA ] = new T[ dequeSize ];
+               ( *map1 )[ block % mapSizeA ] = allocBlock< T >( dequeSize );
 
             for( size_t i = myOffA; i < myOffA + mySizeA; i++ )
             {
@@ -1550,12 +1561,12 @@ void testAssignment26()
                      size_t *mySize2 = reinterpret_cast< size_t * >( &deque2 ) + 3;
 
                      *mapSize2 = mapSizeB;
-                     *map2 = new T * [ mapSizeB ]();
+                     *map2 = allocMap< T >( mapSizeB );
                      *myOff2 = myOffB;
                      *mySize2 = mySizeB;
 
                      for( size_t block = myOffB / dequeSize; block <= ( myOffB + mySizeB - 1 ) / dequeSize; block++ )
-                        ( *map2 )[ block % mapSizeB ] = new T[ dequeSize ];
+                        ( *map2 )[ block % mapSizeB ] = allocBlock< T >( dequeSize );
 
                      for( size_t i = myOffB; i < myOffB + mySizeB; i++ )
                      {
@@ -1626,12 +1637,12 @@ void testAssignment27()
             size_t *mySize1 = reinterpret_cast< size_t * >( &deque1 ) + 3;
 
             *mapSize1 = mapSizeA;
-            *map1 = new T * [ mapSizeA ]();
+            *map1 = allocMap< T >( mapSizeA );
             *myOff1 = myOffA;
             *mySize1 = mySizeA;
 
             for( size_t block = myOffA / dequeSize; block <= ( myOffA + mySizeA - 1 ) / dequeSize; block++ )
-               ( *map1 )[ block % mapSizeA ] = new T[ dequeSize ];
+               ( *map1 )[ block % mapSizeA ] = allocBlock< T >( dequeSize );
 
             for( size_t i = myOffA; i < myOffA + mySizeA; i++ )
             {
@@ -1651,12 +1662,12 @@ void testAssignment27()
                      size_t *mySize2 = reinterpret_cast< size_t * >( &deque2 ) + 3;
 
                      *mapSize2 = mapSizeB;
-                     *map2 = new T * [ mapSizeB ]();
+                     *map2 = allocMap< T >( mapSizeB );
                      *myOff2 = myOffB;
                      *mySize2 = mySizeB;
 
                      for( size_t block = myOffB / dequeSize; block <= ( myOffB + mySizeB - 1 ) / dequeSize; block++ )
-                        ( *map2 )[ block % mapSizeB ] = new T[ dequeSize ];
+                        ( *map2 )[ block % mapSizeB ] = allocBlock< T >( dequeSize );
 
                      for( size_t i = myOffB; i < myOffB + mySizeB; i++ )
                      {
@@ -1726,12 +1737,12 @@ void testAssignment28()
             size_t *mySize1 = reinterpret_cast< size_t * >( &deque1 ) + 3;
 
             *mapSize1 = mapSizeA;
-            *map1 = new T * [ mapSizeA ]();
+            *map1 = allocMap< T >( mapSizeA );
             *myOff1 = myOffA;
             *mySize1 = mySizeA;
 
             for( size_t block = myOffA / dequeSize; block <= ( myOffA + mySizeA - 1 ) / dequeSize; block++ )
-               ( *map1 )[ block % mapSizeA ] = new T[ dequeSize ];
+               ( *map1 )[ block % mapSizeA ] = allocBlock< T >( dequeSize );
 
             for( size_t i = myOffA; i < myOffA + mySizeA; i++ )
             {
@@ -1751,12 +1762,12 @@ void testAssignment28()
                      size_t *mySize2 = reinterpret_cast< size_t * >( &deque2 ) + 3;
 
                      *mapSize2 = mapSizeB;
-                     *map2 = new T * [ mapSizeB ]();
+                     *map2 = allocMap< T >( mapSizeB );
                      *myOff2 = myOffB;
                      *mySize2 = mySizeB;
 
                      for( size_t block = myOffB / dequeSize; block <= ( myOffB + mySizeB - 1 ) / dequeSize; block++ )
-                        ( *map2 )[ block % mapSizeB ] = new T[ dequeSize ];
+                        ( *map2 )[ block % mapSizeB ] = allocBlock< T >( dequeSize );
 
                      for( size_t i = myOffB; i < myOffB + mySizeB; i++ )
                      {
@@ -1807,6 +1818,71 @@ void testAssignment28()
    cout << endl;
 }
 
+// with parallel copy switched on for every size, assigning must put each
+// worker's run of blocks where a single-threaded copy would, whatever the
+// offsets of the source and the destination
+template< typename T >
+void testAssignment29()
+{
+   size_t dequeSize = compDequeSize< T >(); // elements per block (a power of 2)
+   size_t numErrors = 0;
+
+   unsigned threads = DequeParallel::threads;
+   size_t threshold = DequeParallel::threshold;
+   DequeParallel::threads = 4;
+   DequeParallel::threshold = 1;
+
+   for( int i = 0; i < 500; i++ )
+   {
+      size_t mapSize = 8 << ( rand() % 3 );
+      size_t myOff = rand() % ( dequeSize * mapSize );
+      size_t mySize = 1 + rand() % ( dequeSize * ( mapSize - 1 ) );
+
+      deque< T > deque1;
+      T ***map1 = reinterpret_cast< T *** > ( &deque1 );
+      size_t *mapSize1 = reinterpret_cast< size_t * >( &deque1 ) + 1;
+      size_t *myOff1 = reinterpret_cast< size_t * >( &deque1 ) + 2;
+      size_t *mySize1 = reinterpret_cast< size_t * >( &deque1 ) + 3;
+      *mapSize1 = mapSize;
+      *map1 = allocMap< T >( mapSize );
+      *myOff1 = myOff;
+      *mySize1 = mySize;
+      for( size_t block = myOff / dequeSize; block <= ( myOff + mySize - 1 ) / dequeSize; block++ )
+         if( ( *map1 )[ block % mapSize ] == nullptr )
+            ( *map1 )[ block % mapSize ] = allocBlock< T >( dequeSize );
+      for( size_t j = myOff; j < myOff + mySize; j++ )
+         ( *map1 )[ j % ( dequeSize * mapSize ) / dequeSize ][ j % dequeSize ] = static_cast< T >( j );
+
+      deque< T > deque2;
+      deque2.assign( rand() % ( dequeSize * 60 ), static_cast< T >( 0 ) );
+
+      deque2 = deque1;
+
+      bool same = deque2.size() == mySize;
+      const deque< T > &constDeque = deque2;
+      size_t j = myOff;
+      for( typename deque< T >::const_iterator it = constDeque.begin(); same && it != constDeque.end(); ++it, ++j )
+         same = *it == static_cast< T >( j );
+      if( !same )
+         numErrors++;
+   }
+
+   // with no threshold at all, copying an empty deque must not be split
+   DequeParallel::threshold = 0;
+   deque< T > deque4;
+   deque< T > deque5;
+   deque5.assign( 3, static_cast< T >( 1 ) );
+   deque5 = deque4;
+   if( deque5.size() != 0 )
+      numErrors++;
+
+   DequeParallel::threads = threads;
+   DequeParallel::threshold = threshold;
+
+   cout << "There are " << numErrors << " errors\n";
+   cout << endl;
+}
+
 template< typename T >
 bool equal( std::deque< T > &deque1, deque< T > &deque2 )
 {
@@ -1867,4 +1943,22 @@ bool equal( std::deque< T > &deque1, deque< T > &deque2 )
    }
 
    return true;
+}
+
+// allocate a map of mapSize null block pointers with std::allocator, as the
+// deque does, so the deque may release a map injected into it
+template< typename T >
+T** allocMap( size_t mapSize )
+{
+   T** map = std::allocator< T* >().allocate( mapSize );
+   for( size_t i = 0; i < mapSize; i++ )
+      map[ i ] = nullptr;
+   return map;
+}
+
+// allocate a block of dequeSize elements with std::allocator, as the deque does
+template< typename T >
+T* allocBlock( size_t dequeSize )
+{
+   return std::allocator< T >().allocate( dequeSize );
 }
\ No newline at end of file
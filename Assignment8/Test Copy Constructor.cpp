@@ -3,6 +3,7 @@ using std::cout;
 using std::endl;
 
 #include <deque>
+#include <memory>
 #include "Student ID - deque - copy constructor.h"
 
 template< typename T >
@@ -32,9 +33,27 @@ void testCopyConstructor9();
 template< typename T >
 void testCopyConstructor10();
 
+template< typename T >
+void testCopyConstructor11();
+
+template< typename T >
+void testCopyConstructor12();
+
+template< typename T >
+void testCopyConstructor13();
+
+template< typename T >
+void testCopyConstructor14();
+
 template< typename T >
 bool equal( std::deque< T > &deque1, deque< T > &deque2 );
 
+template< typename T >
+T** allocMap( size_t mapSize );
+
+template< typename T >
+T* allocBlock( size_t dequeSize );
+
 int main()
 {
    testCopyConstructor< char >();
@@ -60,6 +79,10 @@ void testCopyConstructor()
    testCopyConstructor8< T >();
    testCopyConstructor9< T >();
    testCopyConstructor10< T >();
+   testCopyConstructor11< T >();
+   testCopyConstructor12< T >();
+   testCopyConstructor13< T >();
+   testCopyConstructor14< T >();
 /*
 */
 }
@@ -99,8 +122,8 @@ void testCopyConstructor1()
 
             *mapSize1 = mapSize;
             *mapSize2 = mapSize;
-            *map1 = new T*[ mapSize ]();
-            *map2 = new T*[ mapSize ]();
+            *map1 = allocMap< T >( mapSize );
+            *map2 = allocMap< T >( mapSize );
             *myOff1 = myOff;
             *myOff2 = myOff;
             *mySize1 = mySize;
@@ -108,8 +131,8 @@ void testCopyConstructor1()
 
             for( size_t block = myOff / dequeSize; block <= ( myOff + mySize - 1 ) / dequeSize; block++ )
             {
-               ( *map1 )[ block % mapSize ] = new T[ dequeSize ];
-               ( *map2 )[ block % mapSize ] = new T[ dequeSize ];
+               ( *map1 )[ block % mapSize ] = allocBlock< T >( dequeSize );
+               ( *map2 )[ block % mapSize ] = allocBlock< T >( dequeSize );
             }
 
             for( size_t i = myOff; i < myOff + mySize; i++ )
@@ -162,8 +185,8 @@ void testCopyConstructor2()
 
             *mapSize1 = mapSize;
             *mapSize2 = mapSize;
-            *map1 = new T*[ mapSize ]();
-            *map2 = new T*[ mapSize ]();
+            *map1 = allocMap< T >( mapSize );
+            *map2 = allocMap< T >( mapSize );
             *myOff1 = myOff;
             *myOff2 = myOff;
             *mySize1 = mySize;
@@ -171,8 +194,8 @@ void testCopyConstructor2()
 
             for( size_t block = myOff / dequeSize; block <= ( myOff + mySize - 1 ) / dequeSize; block++ )
             {
-               ( *map1 )[ block % mapSize ] = new T[ dequeSize ];
-               ( *map2 )[ block % mapSize ] = new T[ dequeSize ];
+               ( *map1 )[ block % mapSize ] = allocBlock< T >( dequeSize );
+               ( *map2 )[ block % mapSize ] = allocBlock< T >( dequeSize );
             }
 
             for( size_t i = myOff; i < myOff + mySize; i++ )
@@ -223,8 +246,8 @@ void testCopyConstructor6()
 
             *mapSize1 = mapSize;
             *mapSize2 = mapSize;
-            *map1 = new T*[ mapSize ]();
-            *map2 = new T*[ mapSize ]();
+            *map1 = allocMap< T >( mapSize );
+            *map2 = allocMap< T >( mapSize );
             *myOff1 = myOff;
             *myOff2 = myOff;
             *mySize1 = mySize;
@@ -232,8 +255,8 @@ void testCopyConstructor6()
 
             for( size_t block = myOff / dequeSize; block <= ( myOff + mySize - 1 ) / dequeSize; block++ )
             {
-               ( *map1 )[ block % mapSize ] = new T[ dequeSize ];
-               ( *map2 )[ block % mapSize ] = new T[ dequeSize ];
+               ( *map1 )[ block % mapSize ] = allocBlock< T >( dequeSize );
+               ( *map2 )[ block % mapSize ] = allocBlock< T >( dequeSize );
             }
 
             for( size_t i = myOff; i < myOff + mySize; i++ )
@@ -284,8 +307,8 @@ void testCopyConstructor7()
 
             *mapSize1 = mapSize;
             *mapSize2 = mapSize;
-            *map1 = new T*[ mapSize ]();
-            *map2 = new T*[ mapSize ]();
+            *map1 = allocMap< T >( mapSize );
+            *map2 = allocMap< T >( mapSize );
             *myOff1 = myOff;
             *myOff2 = myOff;
             *mySize1 = mySize;
@@ -293,8 +316,8 @@ void testCopyConstructor7()
 
             for( size_t block = myOff / dequeSize; block <= ( myOff + mySize - 1 ) / dequeSize; block++ )
             {
-               ( *map1 )[ block % mapSize ] = new T[ dequeSize ];
-               ( *map2 )[ block % mapSize ] = new T[ dequeSize ];
+               ( *map1 )[ block % mapSize ] = allocBlock< T >( dequeSize );
+               ( *map2 )[ block % mapSize ] = allocBlock< T >( dequeSize );
             }
 
             for( size_t i = myOff; i < myOff + mySize; i++ )
@@ -345,8 +368,8 @@ void testCopyConstructor8()
 
             *mapSize1 = mapSize;
             *mapSize2 = mapSize;
-            *map1 = new T*[ mapSize ]();
-            *map2 = new T*[ mapSize ]();
+            *map1 = allocMap< T >( mapSize );
+            *map2 = allocMap< T >( mapSize );
             *myOff1 = myOff;
             *myOff2 = myOff;
             *mySize1 = mySize;
@@ -354,8 +377,8 @@ void testCopyConstructor8()
 
             for( size_t block = myOff / dequeSize; block <= ( myOff + mySize - 1 ) / dequeSize; block++ )
             {
-               ( *map1 )[ block % mapSize ] = new T[ dequeSize ];
-               ( *map2 )[ block % mapSize ] = new T[ dequeSize ];
+               ( *map1 )[ block % mapSize ] = allocBlock< T >( dequeSize );
+               ( *map2 )[ block % mapSize ] = allocBlock< T >( dequeSize );
             }
 
             for( size_t i = myOff; i < myOff + mySize; i++ )
@@ -406,8 +429,8 @@ void testCopyConstructor9()
 
             *mapSize1 = mapSize;
             *mapSize2 = mapSize;
-            *map1 = new T*[ mapSize ]();
-            *map2 = new T*[ mapSize ]();
+            *map1 = allocMap< T >( mapSize );
+            *map2 = allocMap< T >( mapSize );
             *myOff1 = myOff;
             *myOff2 = myOff;
             *mySize1 = mySize;
@@ -415,8 +438,8 @@ void testCopyConstructor9()
 
             for( size_t block = myOff / dequeSize; block <= ( myOff + mySize - 1 ) / dequeSize; block++ )
             {
-               ( *map1 )[ block % mapSize ] = new T[ dequeSize ];
-               ( *map2 )[ block % mapSize ] = new T[ dequeSize ];
+               ( *map1 )[ block % mapSize ] = allocBlock< T >( dequeSize );
+               ( *map2 )[ block % mapSize ] = allocBlock< T >( dequeSize );
             }
 
             for( size_t i = myOff; i < myOff + mySize; i++ )
@@ -462,8 +485,8 @@ void testCopyConstructor10()
 
       *mapSize1 = mapSize;
       *mapSize2 = mapSize;
-      *map1 = new T*[ mapSize ]();
-      *map2 = new T*[ mapSize ]();
+      *map1 = allocMap< T >( mapSize );
+      *map2 = allocMap< T >( mapSize );
       size_t myOff = 0;
       size_t mySize = 0;
       *myOff1 = myOff;
@@ -481,6 +504,247 @@ void testCopyConstructor10()
    cout << "There are " << numErrors << " errors\n\n";
 }
 
+// take copy-on-write snapshots, write a few positions in each deque and check
+// that only the written blocks stop being shared
+template< typename T >
+void testCopyConstructor11()
+{
+   size_t dequeSize = compDequeSize< T >(); // elements per block (a power of 2)
+   size_t numErrors = 0;
+
+   for( int i = 0; i < 500; i++ )
+   {
+      size_t mapSize = 8 << ( rand() % 3 );
+      size_t myOff = rand() % ( dequeSize * mapSize );
+      size_t mySize = 1 + rand() % ( dequeSize * ( mapSize - 1 ) );
+
+      std::deque< T > deque1;
+      deque< T > *deque2 = new deque< T >;
+      T ***map2 = reinterpret_cast< T *** > ( deque2 );
+      size_t *mapSize2 = reinterpret_cast< size_t * >( deque2 ) + 1;
+      size_t *myOff2 = reinterpret_cast< size_t * >( deque2 ) + 2;
+      size_t *mySize2 = reinterpret_cast< size_t * >( deque2 ) + 3;
+
+      *mapSize2 = mapSize;
+      *map2 = allocMap< T >( mapSize );
+      *myOff2 = myOff;
+      *mySize2 = mySize;
+      for( size_t block = myOff / dequeSize; block <= ( myOff + mySize - 1 ) / dequeSize; block++ )
+         if( ( *map2 )[ block % mapSize ] == nullptr )
+            ( *map2 )[ block % mapSize ] = allocBlock< T >( dequeSize );
+      for( size_t j = myOff; j < myOff + mySize; j++ )
+      {
+         ( *map2 )[ j % ( dequeSize * mapSize ) / dequeSize ][ j % dequeSize ] = static_cast< T >( j );
+         deque1.push_back( static_cast< T >( j ) );
+      }
+
+      std::deque< T > models[ 3 ] = { deque1, deque1, deque1 };
+      deque< T > *deques[ 3 ] = { deque2, new deque< T >( deque2->snapshot() ), nullptr };
+      deques[ 2 ] = new deque< T >( deques[ 1 ]->snapshot() );
+
+      T **map3 = *reinterpret_cast< T *** > ( deques[ 2 ] );
+      if( map3 == *map2 || map3[ myOff / dequeSize % mapSize ] != ( *map2 )[ myOff / dequeSize % mapSize ] )
+         numErrors++;
+
+      // a write clones the block it lands in, and no other
+      size_t pos = rand() % mySize;
+      size_t row = ( myOff + pos ) / dequeSize % mapSize;
+      size_t other = ( row + 1 ) % mapSize;
+      T *before = map3[ other ];
+      deques[ 2 ]->modify( pos ) = static_cast< T >( 1 );
+      models[ 2 ][ pos ] = static_cast< T >( 1 );
+      if( map3[ row ] == ( *map2 )[ row ] || map3[ other ] != before )
+         numErrors++;
+
+      for( int j = 0; j < 20; j++ )
+      {
+         size_t which = rand() % 3;
+         pos = rand() % mySize;
+         T value = static_cast< T >( rand() );
+         deques[ which ]->modify( pos ) = value;
+         models[ which ][ pos ] = value;
+      }
+
+      for( size_t j = 0; j < 3; j++ )
+      {
+         const deque< T > &constDeque = *deques[ j ];
+         typename deque< T >::const_iterator it = constDeque.begin();
+         for( size_t k = 0; k < mySize; ++k, ++it )
+            if( *it != models[ j ][ k ] )
+               numErrors++;
+      }
+
+      size_t order = rand() % 3;
+      for( size_t j = 0; j < 3; j++ )
+         delete deques[ ( order + j ) % 3 ];
+   }
+
+   cout << "There are " << numErrors << " errors\n\n";
+}
+
+// a copy lays its blocks out back to back in one slab; a snapshot of the copy
+// keeps the slab alive after the copy itself is gone
+template< typename T >
+void testCopyConstructor12()
+{
+   size_t dequeSize = compDequeSize< T >(); // elements per block (a power of 2)
+   size_t numErrors = 0;
+
+   for( int i = 0; i < 500; i++ )
+   {
+      size_t mapSize = 8 << ( rand() % 3 );
+      size_t myOff = rand() % ( dequeSize * mapSize );
+      size_t mySize = 1 + rand() % ( dequeSize * ( mapSize - 1 ) );
+
+      deque< T > deque2;
+      T ***map2 = reinterpret_cast< T *** > ( &deque2 );
+      size_t *mapSize2 = reinterpret_cast< size_t * >( &deque2 ) + 1;
+      size_t *myOff2 = reinterpret_cast< size_t * >( &deque2 ) + 2;
+      size_t *mySize2 = reinterpret_cast< size_t * >( &deque2 ) + 3;
+      *mapSize2 = mapSize;
+      *map2 = allocMap< T >( mapSize );
+      *myOff2 = myOff;
+      *mySize2 = mySize;
+      for( size_t block = myOff / dequeSize; block <= ( myOff + mySize - 1 ) / dequeSize; block++ )
+         if( ( *map2 )[ block % mapSize ] == nullptr )
+            ( *map2 )[ block % mapSize ] = allocBlock< T >( dequeSize );
+      for( size_t j = myOff; j < myOff + mySize; j++ )
+         ( *map2 )[ j % ( dequeSize * mapSize ) / dequeSize ][ j % dequeSize ] = static_cast< T >( j );
+
+      deque< T > *deque3 = new deque< T >( deque2 );
+      T **map3 = *reinterpret_cast< T *** > ( deque3 );
+      for( size_t block = 1; block < ( mySize + dequeSize - 1 ) / dequeSize; block++ )
+         if( map3[ block ] != map3[ 0 ] + block * dequeSize )
+            numErrors++;
+
+      deque< T > deque4( deque3->snapshot() );
+      if( rand() % 2 == 0 )
+         deque3->modify( rand() % mySize ) = static_cast< T >( 1 );
+      delete deque3;
+
+      const deque< T > &constDeque = deque4;
+      typename deque< T >::const_iterator it = constDeque.begin();
+      for( size_t j = myOff; j < myOff + mySize; ++j, ++it )
+         if( *it != static_cast< T >( j ) )
+            numErrors++;
+   }
+
+   cout << "There are " << numErrors << " errors\n\n";
+}
+
+// with parallel copy switched on for every size, each worker's run of
+// blocks must land where a single-threaded copy would put it
+template< typename T >
+void testCopyConstructor13()
+{
+   size_t dequeSize = compDequeSize< T >(); // elements per block (a power of 2)
+   size_t numErrors = 0;
+
+   unsigned threads = DequeParallel::threads;
+   size_t threshold = DequeParallel::threshold;
+   DequeParallel::threads = 4;
+   DequeParallel::threshold = 1;
+
+   for( int i = 0; i < 500; i++ )
+   {
+      size_t mapSize = 8 << ( rand() % 3 );
+      size_t myOff = rand() % ( dequeSize * mapSize );
+      size_t mySize = 1 + rand() % ( dequeSize * ( mapSize - 1 ) );
+
+      std::deque< T > deque1;
+      deque< T > deque2;
+      T ***map2 = reinterpret_cast< T *** > ( &deque2 );
+      size_t *mapSize2 = reinterpret_cast< size_t * >( &deque2 ) + 1;
+      size_t *myOff2 = reinterpret_cast< size_t * >( &deque2 ) + 2;
+      size_t *mySize2 = reinterpret_cast< size_t * >( &deque2 ) + 3;
+      *mapSize2 = mapSize;
+      *map2 = allocMap< T >( mapSize );
+      *myOff2 = myOff;
+      *mySize2 = mySize;
+      for( size_t block = myOff / dequeSize; block <= ( myOff + mySize - 1 ) / dequeSize; block++ )
+         if( ( *map2 )[ block % mapSize ] == nullptr )
+            ( *map2 )[ block % mapSize ] = allocBlock< T >( dequeSize );
+      for( size_t j = myOff; j < myOff + mySize; j++ )
+      {
+         ( *map2 )[ j % ( dequeSize * mapSize ) / dequeSize ][ j % dequeSize ] = static_cast< T >( j );
+         deque1.push_back( static_cast< T >( j ) );
+      }
+
+      deque< T > deque3( deque2 );
+      const deque< T > &constDeque = deque3;
+      typename deque< T >::const_iterator it = constDeque.begin();
+      for( size_t j = 0; j < mySize; ++j, ++it )
+         if( *it != deque1[ j ] )
+            numErrors++;
+   }
+
+   // with no threshold at all, copying an empty deque must not be split
+   DequeParallel::threshold = 0;
+   const deque< T > deque4;
+   const deque< T > deque5( deque4 );
+   if( deque5.begin() != deque5.end() )
+      numErrors++;
+
+   DequeParallel::threads = threads;
+   DequeParallel::threshold = threshold;
+
+   cout << "There are " << numErrors << " errors\n\n";
+}
+
+// reading a snapshot and its source through cbegin() and cend() leaves every
+// block shared; begin() makes the blocks of its deque its own
+template< typename T >
+void testCopyConstructor14()
+{
+   size_t dequeSize = compDequeSize< T >(); // elements per block (a power of 2)
+   size_t numErrors = 0;
+
+   for( int i = 0; i < 500; i++ )
+   {
+      size_t mapSize = 8 << ( rand() % 3 );
+      size_t myOff = rand() % ( dequeSize * mapSize );
+      size_t mySize = 1 + rand() % ( dequeSize * ( mapSize - 1 ) );
+
+      deque< T > deque2;
+      T ***map2 = reinterpret_cast< T *** > ( &deque2 );
+      size_t *mapSize2 = reinterpret_cast< size_t * >( &deque2 ) + 1;
+      size_t *myOff2 = reinterpret_cast< size_t * >( &deque2 ) + 2;
+      size_t *mySize2 = reinterpret_cast< size_t * >( &deque2 ) + 3;
+      *mapSize2 = mapSize;
+      *map2 = allocMap< T >( mapSize );
+      *myOff2 = myOff;
+      *mySize2 = mySize;
+      for( size_t block = myOff / dequeSize; block <= ( myOff + mySize - 1 ) / dequeSize; block++ )
+         if( ( *map2 )[ block % mapSize ] == nullptr )
+            ( *map2 )[ block % mapSize ] = allocBlock< T >( dequeSize );
+      for( size_t j = myOff; j < myOff + mySize; j++ )
+         ( *map2 )[ j % ( dequeSize * mapSize ) / dequeSize ][ j % dequeSize ] = static_cast< T >( j );
+
+      deque< T > deque3( deque2.snapshot() );
+      T **map3 = *reinterpret_cast< T *** > ( &deque3 );
+      size_t row = myOff / dequeSize % mapSize;
+
+      deque< T > *deques[ 2 ] = { &deque2, &deque3 };
+      for( size_t k = 0; k < 2; k++ )
+      {
+         size_t j = myOff;
+         for( typename deque< T >::const_iterator it = deques[ k ]->cbegin(); it != deques[ k ]->cend(); ++it, ++j )
+            if( *it != static_cast< T >( j ) )
+               numErrors++;
+         if( j != myOff + mySize )
+            numErrors++;
+      }
+      if( map3[ row ] != ( *map2 )[ row ] )
+         numErrors++;
+
+      deque3.begin();
+      if( map3[ row ] == ( *map2 )[ row ] )
+         numErrors++;
+   }
+
+   cout << "There are " << numErrors << " errors\n\n";
+}
+
 template< typename T >
 bool equal( std::deque< T > &deque1, deque< T > &deque2 )
 {
@@ -531,4 +795,22 @@ bool equal( std::deque< T > &deque1, deque< T > &deque2 )
    }
 
    return true;
+}
+
+// allocate a map of mapSize null block pointers with std::allocator, as the
+// deque does, so the deque may release a map injected into it
+template< typename T >
+T** allocMap( size_t mapSize )
+{
+   T** map = std::allocator< T* >().allocate( mapSize );
+   for( size_t i = 0; i < mapSize; i++ )
+      map[ i ] = nullptr;
+   return map;
+}
+
+// allocate a block of dequeSize elements with std::allocator, as the deque does
+template< typename T >
+T* allocBlock( size_t dequeSize )
+{
+   return std::allocator< T >().allocate( dequeSize );
 }
\ No newline at end of file
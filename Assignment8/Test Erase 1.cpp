@@ -3,6 +3,7 @@ using std::cout;
 using std::endl;
 
 #include <deque>
+#include <memory>
 #include "Student ID - deque - erase.h"
 
 template< typename T >
@@ -38,9 +39,27 @@ void testErase8();
 template< typename T >
 void testErase9();
 
+template< typename T >
+void testErase10();
+
+template< typename T >
+void testErase11();
+
+template< typename T, size_t Count >
+void testErase12();
+
 template< typename T >
 bool equal( std::deque< T > &data1, deque< T > &data2 );
 
+template< typename T >
+bool sameElements( std::deque< T > &data1, deque< T > &data2 );
+
+template< typename T >
+T** allocMap( size_t mapSize );
+
+template< typename T >
+T* allocBlock( size_t dequeSize );
+
 int main()
 {
    testErase< char >();
@@ -81,6 +100,10 @@ void testErase()
    testErase7< T >();
    testErase8< T >();
    testErase9< T >();
+   testErase10< T >();
+   testErase11< T >();
+   testErase12< T, 1 >();
+   testErase12< T, 4 >();
 /*
 */
 }
@@ -115,8 +138,8 @@ void testErase1()
 
                *mapSize1 = mapSize;
                *mapSize2 = mapSize;
-               *map1 = new T * [ mapSize ]();
-               *map2 = new T * [ mapSize ]();
+               *map1 = allocMap< T >( mapSize );
+               *map2 = allocMap< T >( mapSize );
                *myOff1 = myOff;
                *myOff2 = myOff;
                *mySize1 = mySize;
@@ -124,8 +147,8 @@ void testErase1()
 
                for( size_t block = myOff / dequeSize; block <= ( myOff + mySize - 1 ) / dequeSize; block++ )
                {
-                  ( *map1 )[ block % mapSize ] = new T[ dequeSize ];
-                  ( *map2 )[ block % mapSize ] = new T[ dequeSize ];
+                  ( *map1 )[ block % mapSize ] = allocBlock< T >( dequeSize );
+                  ( *map2 )[ block % mapSize ] = allocBlock< T >( dequeSize );
                }
 
                for( size_t i = myOff; i < myOff + mySize; i++ )
@@ -181,8 +204,8 @@ void testErase2()
 
             *mapSize1 = mapSize;
             *mapSize2 = mapSize;
-            *map1 = new T*[ mapSize ]();
-            *map2 = new T*[ mapSize ]();
+            *map1 = allocMap< T >( mapSize );
+            *map2 = allocMap< T >( mapSize );
             *myOff1 = myOff;
             *myOff2 = myOff;
             *mySize1 = mySize;
@@ -190,8 +213,8 @@ void testErase2()
 
             for( size_t block = myOff / dequeSize; block <= ( myOff + mySize - 1 ) / dequeSize; block++ )
             {
-               ( *map1 )[ block % mapSize ] = new T[ dequeSize ];
-               ( *map2 )[ block % mapSize ] = new T[ dequeSize ];
+               ( *map1 )[ block % mapSize ] = allocBlock< T >( dequeSize );
+               ( *map2 )[ block % mapSize ] = allocBlock< T >( dequeSize );
             }
 
             for( size_t i = myOff; i < myOff + mySize; i++ )
@@ -243,8 +266,8 @@ void testErase3()
 
                *mapSize1 = mapSize;
                *mapSize2 = mapSize;
-               *map1 = new T * [ mapSize ]();
-               *map2 = new T * [ mapSize ]();
+               *map1 = allocMap< T >( mapSize );
+               *map2 = allocMap< T >( mapSize );
                *myOff1 = myOff;
                *myOff2 = myOff;
                *mySize1 = mySize;
@@ -252,8 +275,8 @@ void testErase3()
 
                for( size_t block = myOff / dequeSize; block <= ( myOff + mySize - 1 ) / dequeSize; block++ )
                {
-                  ( *map1 )[ block % mapSize ] = new T[ dequeSize ];
-                  ( *map2 )[ block % mapSize ] = new T[ dequeSize ];
+                  ( *map1 )[ block % mapSize ] = allocBlock< T >( dequeSize );
+                  ( *map2 )[ block % mapSize ] = allocBlock< T >( dequeSize );
                }
 
                for( size_t i = myOff; i < myOff + mySize; i++ )
@@ -311,8 +334,8 @@ void testErase4()
 
                *mapSize1 = mapSize;
                *mapSize2 = mapSize;
-               *map1 = new T * [ mapSize ]();
-               *map2 = new T * [ mapSize ]();
+               *map1 = allocMap< T >( mapSize );
+               *map2 = allocMap< T >( mapSize );
                *myOff1 = myOff;
                *myOff2 = myOff;
                *mySize1 = mySize;
@@ -320,8 +343,8 @@ void testErase4()
 
                for( size_t block = myOff / dequeSize; block <= ( myOff + mySize - 1 ) / dequeSize; block++ )
                {
-                  ( *map1 )[ block % mapSize ] = new T[ dequeSize ];
-                  ( *map2 )[ block % mapSize ] = new T[ dequeSize ];
+                  ( *map1 )[ block % mapSize ] = allocBlock< T >( dequeSize );
+                  ( *map2 )[ block % mapSize ] = allocBlock< T >( dequeSize );
                }
 
                for( size_t i = myOff; i < myOff + mySize; i++ )
@@ -393,8 +416,8 @@ void testErase5()
 
                *mapSize1 = mapSize;
                *mapSize2 = mapSize;
-               *map1 = new T * [ mapSize ]();
-               *map2 = new T * [ mapSize ]();
+               *map1 = allocMap< T >( mapSize );
+               *map2 = allocMap< T >( mapSize );
                *myOff1 = myOff;
                *myOff2 = myOff;
                *mySize1 = mySize;
@@ -402,8 +425,8 @@ void testErase5()
 
                for( size_t block = myOff / dequeSize; block <= ( myOff + mySize - 1 ) / dequeSize; block++ )
                {
-                  ( *map1 )[ block % mapSize ] = new T[ dequeSize ];
-                  ( *map2 )[ block % mapSize ] = new T[ dequeSize ];
+                  ( *map1 )[ block % mapSize ] = allocBlock< T >( dequeSize );
+                  ( *map2 )[ block % mapSize ] = allocBlock< T >( dequeSize );
                }
 
                for( size_t i = myOff; i < myOff + mySize; i++ )
@@ -478,8 +501,8 @@ void testErase6()
 
             *mapSize1 = mapSize;
             *mapSize2 = mapSize;
-            *map1 = new T*[ mapSize ]();
-            *map2 = new T*[ mapSize ]();
+            *map1 = allocMap< T >( mapSize );
+            *map2 = allocMap< T >( mapSize );
             *myOff1 = myOff;
             *myOff2 = myOff;
             *mySize1 = mySize;
@@ -487,8 +510,8 @@ void testErase6()
 
             for( size_t block = myOff / dequeSize; block <= ( myOff + mySize - 1 ) / dequeSize; block++ )
             {
-               ( *map1 )[ block % mapSize ] = new T[ dequeSize ];
-               ( *map2 )[ block % mapSize ] = new T[ dequeSize ];
+               ( *map1 )[ block % mapSize ] = allocBlock< T >( dequeSize );
+               ( *map2 )[ block % mapSize ] = allocBlock< T >( dequeSize );
             }
 
             for( size_t i = myOff; i < myOff + mySize; i++ )
@@ -539,8 +562,8 @@ void testErase7()
 
             *mapSize1 = mapSize;
             *mapSize2 = mapSize;
-            *map1 = new T*[ mapSize ]();
-            *map2 = new T*[ mapSize ]();
+            *map1 = allocMap< T >( mapSize );
+            *map2 = allocMap< T >( mapSize );
             *myOff1 = myOff;
             *myOff2 = myOff;
             *mySize1 = mySize;
@@ -548,8 +571,8 @@ void testErase7()
 
             for( size_t block = myOff / dequeSize; block <= ( myOff + mySize - 1 ) / dequeSize; block++ )
             {
-               ( *map1 )[ block % mapSize ] = new T[ dequeSize ];
-               ( *map2 )[ block % mapSize ] = new T[ dequeSize ];
+               ( *map1 )[ block % mapSize ] = allocBlock< T >( dequeSize );
+               ( *map2 )[ block % mapSize ] = allocBlock< T >( dequeSize );
             }
 
             for( size_t i = myOff; i < myOff + mySize; i++ )
@@ -619,8 +642,8 @@ void testErase8()
 
             *mapSize1 = mapSize;
             *mapSize2 = mapSize;
-            *map1 = new T*[ mapSize ]();
-            *map2 = new T*[ mapSize ]();
+            *map1 = allocMap< T >( mapSize );
+            *map2 = allocMap< T >( mapSize );
             *myOff1 = myOff;
             *myOff2 = myOff;
             *mySize1 = mySize;
@@ -628,8 +651,8 @@ void testErase8()
 
             for( size_t block = myOff / dequeSize; block <= ( myOff + mySize - 1 ) / dequeSize; block++ )
             {
-               ( *map1 )[ block % mapSize ] = new T[ dequeSize ];
-               ( *map2 )[ block % mapSize ] = new T[ dequeSize ];
+               ( *map1 )[ block % mapSize ] = allocBlock< T >( dequeSize );
+               ( *map2 )[ block % mapSize ] = allocBlock< T >( dequeSize );
             }
 
             for( size_t i = myOff; i < myOff + mySize; i++ )
@@ -680,8 +703,8 @@ void testErase9()
 
             *mapSize1 = mapSize;
             *mapSize2 = mapSize;
-            *map1 = new T*[ mapSize ]();
-            *map2 = new T*[ mapSize ]();
+            *map1 = allocMap< T >( mapSize );
+            *map2 = allocMap< T >( mapSize );
             *myOff1 = myOff;
             *myOff2 = myOff;
             *mySize1 = mySize;
@@ -689,8 +712,8 @@ void testErase9()
 
             for( size_t block = myOff / dequeSize; block <= ( myOff + mySize - 1 ) / dequeSize; block++ )
             {
-               ( *map1 )[ block % mapSize ] = new T[ dequeSize ];
-               ( *map2 )[ block % mapSize ] = new T[ dequeSize ];
+               ( *map1 )[ block % mapSize ] = allocBlock< T >( dequeSize );
+               ( *map2 )[ block % mapSize ] = allocBlock< T >( dequeSize );
             }
 
             for( size_t i = myOff; i < myOff + mySize; i++ )
@@ -731,6 +754,193 @@ void testErase9()
    cout << endl;
 }
 
+// range erase( first, last ) on random layouts;
+// only the element sequence is compared, as the block layout is free
+template< typename T >
+void testErase10()
+{
+   size_t dequeSize = compDequeSize< T >(); // elements per block (a power of 2)
+   size_t numErrors = 0;
+
+   for( int i = 0; i < 2000; i++ )
+   {
+      size_t mapSize = 8 << ( rand() % 3 );
+      size_t myOff = rand() % ( dequeSize * mapSize );
+      size_t mySize = rand() % ( dequeSize * ( mapSize - 1 ) + 1 );
+
+      std::deque< T > deque1;
+      deque< T > deque2;
+      T ***map2 = reinterpret_cast< T *** > ( &deque2 );
+      size_t *mapSize2 = reinterpret_cast< size_t * >( &deque2 ) + 1;
+      size_t *myOff2 = reinterpret_cast< size_t * >( &deque2 ) + 2;
+      size_t *mySize2 = reinterpret_cast< size_t * >( &deque2 ) + 3;
+
+      *mapSize2 = mapSize;
+      *map2 = allocMap< T >( mapSize );
+      *myOff2 = myOff;
+      *mySize2 = mySize;
+
+      if( mySize > 0 )
+         for( size_t block = myOff / dequeSize; block <= ( myOff + mySize - 1 ) / dequeSize; block++ )
+            ( *map2 )[ block % mapSize ] = allocBlock< T >( dequeSize );
+
+      for( size_t j = myOff; j < myOff + mySize; j++ )
+      {
+         ( *map2 )[ j % ( dequeSize * mapSize ) / dequeSize ][ j % dequeSize ] = static_cast< T >( j );
+         deque1.push_back( static_cast< T >( j ) );
+      }
+
+      for( int j = 0; j < 4 && !deque1.empty(); j++ )
+      {
+         size_t first = rand() % ( deque1.size() + 1 );
+         size_t last = first + rand() % ( deque1.size() - first + 1 );
+         deque1.erase( deque1.begin() + first, deque1.begin() + last );
+         typename deque< T >::iterator it = deque2.erase( deque2.begin() + first, deque2.begin() + last );
+
+         if( it != deque2.begin() + first || !sameElements( deque1, deque2 ) )
+            numErrors++;
+      }
+   }
+
+   cout << "There are " << numErrors << " errors\n\n";
+}
+
+// erase most of a large deque with auto trim on, then shrink_to_fit;
+// the map must halve as it empties and end at its smallest size
+template< typename T >
+void testErase11()
+{
+   size_t dequeSize = compDequeSize< T >(); // elements per block (a power of 2)
+   size_t numErrors = 0;
+
+   for( int i = 0; i < 500; i++ )
+   {
+      size_t mapSize = 8 << ( rand() % 5 );
+      size_t myOff = rand() % ( dequeSize * mapSize );
+      size_t mySize = rand() % ( dequeSize * ( mapSize - 1 ) + 1 );
+
+      std::deque< T > deque1;
+      deque< T > deque2;
+      T ***map2 = reinterpret_cast< T *** > ( &deque2 );
+      size_t *mapSize2 = reinterpret_cast< size_t * >( &deque2 ) + 1;
+      size_t *myOff2 = reinterpret_cast< size_t * >( &deque2 ) + 2;
+      size_t *mySize2 = reinterpret_cast< size_t * >( &deque2 ) + 3;
+
+      *mapSize2 = mapSize;
+      *map2 = allocMap< T >( mapSize );
+      *myOff2 = myOff;
+      *mySize2 = mySize;
+
+      if( mySize > 0 )
+         for( size_t block = myOff / dequeSize; block <= ( myOff + mySize - 1 ) / dequeSize; block++ )
+            ( *map2 )[ block % mapSize ] = allocBlock< T >( dequeSize );
+
+      for( size_t j = myOff; j < myOff + mySize; j++ )
+      {
+         ( *map2 )[ j % ( dequeSize * mapSize ) / dequeSize ][ j % dequeSize ] = static_cast< T >( j );
+         deque1.push_back( static_cast< T >( j ) );
+      }
+
+      deque2.set_auto_trim( 25 );
+      while( deque1.size() > 3 )
+      {
+         size_t first = rand() % deque1.size();
+         size_t last = first + 1 + rand() % ( ( deque1.size() - first + 3 ) / 4 );
+         deque1.erase( deque1.begin() + first, deque1.begin() + last );
+         if( last == first + 1 )
+            deque2.erase( deque2.begin() + first );
+         else
+            deque2.erase( deque2.begin() + first, deque2.begin() + last );
+
+         if( !sameElements( deque1, deque2 ) ||
+             ( *mapSize2 > 8 && deque2.size() * 4 < *mapSize2 * dequeSize ) )
+            numErrors++;
+      }
+
+      deque2.shrink_to_fit();
+      if( !sameElements( deque1, deque2 ) || *mapSize2 != ( deque2.empty() ? 0 : 8 ) )
+         numErrors++;
+   }
+
+   cout << "There are " << numErrors << " errors\n\n";
+}
+
+template< typename T >
+bool sameElements( std::deque< T > &data1, deque< T > &data2 )
+{
+   if( data1.size() != data2.size() )
+      return false;
+
+   typename deque< T >::iterator it2 = data2.begin();
+   for( size_t i = 0; i < data1.size(); ++i, ++it2 )
+      if( data1[ i ] != *it2 )
+         return false;
+
+   return true;
+}
+
+// with Count elements per block, erase single elements and ranges from deques
+// at every offset in the map and compare what is left, read back by index
+template< typename T, size_t Count >
+void testErase12()
+{
+   const size_t mapSize = 8;
+   size_t numErrors = 0;
+
+   for( size_t myOff = 0; myOff < Count * mapSize; myOff++ )
+      for( int i = 0; i < 100; i++ )
+      {
+         size_t mySize = rand() % ( Count * ( mapSize - 1 ) + 1 );
+
+         std::deque< T > deque1;
+         deque< T, DequeBlockElements< Count > > deque2;
+         T ***map2 = reinterpret_cast< T *** > ( &deque2 );
+         size_t *mapSize2 = reinterpret_cast< size_t * >( &deque2 ) + 1;
+         size_t *myOff2 = reinterpret_cast< size_t * >( &deque2 ) + 2;
+         size_t *mySize2 = reinterpret_cast< size_t * >( &deque2 ) + 3;
+
+         *mapSize2 = mapSize;
+         *map2 = allocMap< T >( mapSize );
+         *myOff2 = myOff;
+         *mySize2 = mySize;
+
+         if( mySize > 0 )
+            for( size_t block = myOff / Count; block <= ( myOff + mySize - 1 ) / Count; block++ )
+               ( *map2 )[ block % mapSize ] = allocBlock< T >( Count );
+
+         for( size_t j = myOff; j < myOff + mySize; j++ )
+         {
+            ( *map2 )[ j % ( Count * mapSize ) / Count ][ j % Count ] = static_cast< T >( j );
+            deque1.push_back( static_cast< T >( j ) );
+         }
+
+         for( int j = 0; j < 4 && !deque1.empty(); j++ )
+         {
+            typename deque< T, DequeBlockElements< Count > >::iterator it;
+            size_t first = rand() % deque1.size();
+            if( rand() % 2 == 0 )
+            {
+               deque1.erase( deque1.begin() + first );
+               it = deque2.erase( deque2.begin() + first );
+            }
+            else
+            {
+               size_t last = first + rand() % ( deque1.size() - first + 1 );
+               deque1.erase( deque1.begin() + first, deque1.begin() + last );
+               it = deque2.erase( deque2.begin() + first, deque2.begin() + last );
+            }
+
+            if( it != deque2.begin() + first || deque2.size() != deque1.size() )
+               numErrors++;
+            for( size_t k = 0; k < deque1.size(); k++ )
+               if( deque2[ k ] != deque1[ k ] )
+                  numErrors++;
+         }
+      }
+
+   cout << "There are " << numErrors << " errors\n\n";
+}
+
 template< typename T >
 bool equal( std::deque< T > &data1, deque< T > &data2 )
 {
@@ -788,4 +998,22 @@ bool equal( std::deque< T > &data1, deque< T > &data2 )
    }
 
    return true;
+}
+
+// allocate a map of mapSize null block pointers with std::allocator, as the
+// deque does, so the deque may release a map injected into it
+template< typename T >
+T** allocMap( size_t mapSize )
+{
+   T** map = std::allocator< T* >().allocate( mapSize );
+   for( size_t i = 0; i < mapSize; i++ )
+      map[ i ] = nullptr;
+   return map;
+}
+
+// allocate a block of dequeSize elements with std::allocator, as the deque does
+template< typename T >
+T* allocBlock( size_t dequeSize )
+{
+   return std::allocator< T >().allocate( dequeSize );
 }
\ No newline at end of file
@@ -3,11 +3,20 @@ using std::cout;
 using std::endl;
 
 #include <deque>
+#include <iterator>
+#include <sstream>
+#include <vector>
 #include "Student ID - deque - fill constructor.h"
 
 template< typename T >
 void testFillConstructor();
 
+template< typename T >
+void testFillConstructor2();
+
+template< typename T >
+void testFillConstructor3();
+
 template< typename T >
 size_t compDequeSize();
 
@@ -20,6 +29,16 @@ int main()
    testFillConstructor< short >();
    testFillConstructor< long >();
    testFillConstructor< long long >();
+
+   testFillConstructor2< char >();
+   testFillConstructor2< short >();
+   testFillConstructor2< long >();
+   testFillConstructor2< long long >();
+
+   testFillConstructor3< char >();
+   testFillConstructor3< short >();
+   testFillConstructor3< long >();
+   testFillConstructor3< long long >();
    system( "pause" );
 }
 
@@ -48,6 +67,82 @@ void testFillConstructor()
    cout << "There are " << numErrors << " errors\n\n";
 }
 
+// the blocks of a filled deque are carved, in order, from one contiguous slab,
+// and every element holds the fill value
+template< typename T >
+void testFillConstructor2()
+{
+   size_t dequeSize = compDequeSize< T >(); // elements per block (a power of 2)
+   size_t numErrors = 0;
+
+   for( size_t count = 1; count <= dequeSize * 40; count++ )
+   {
+      T value = static_cast< T >( count * 7 + 3 );
+      deque< T > deque2( count, value );
+      T **map2 = *( reinterpret_cast< T *** > ( &deque2 ) );
+
+      bool same = true;
+      for( size_t block = 1; same && block < ( count + dequeSize - 1 ) / dequeSize; block++ )
+         same = map2[ block ] == map2[ 0 ] + block * dequeSize;
+
+      size_t n = 0;
+      for( typename deque< T >::iterator it = deque2.begin(); same && it != deque2.end(); ++it, ++n )
+         same = *it == value;
+
+      if( !same || n != count )
+         numErrors++;
+   }
+
+   cout << "There are " << numErrors << " errors\n\n";
+}
+
+// construct from a forward range, carved from one slab, from a stream read
+// through input iterators, and from an initializer list
+template< typename T >
+void testFillConstructor3()
+{
+   size_t dequeSize = compDequeSize< T >(); // elements per block (a power of 2)
+   size_t numErrors = 0;
+
+   for( int i = 0; i < 200; i++ )
+   {
+      std::vector< T > vector1;
+      std::ostringstream stream;
+      for( int j = rand() % 1000; j > 0; j-- )
+      {
+         T value = static_cast< T >( rand() );
+         vector1.push_back( value );
+         stream << static_cast< long long >( value ) << ' ';
+      }
+
+      deque< T > deque2( vector1.begin(), vector1.end() );
+      std::istringstream input( stream.str() );
+      deque< T > deque3( std::istream_iterator< long long >( input ), ( std::istream_iterator< long long >() ) );
+
+      T **map2 = *( reinterpret_cast< T *** > ( &deque2 ) );
+      for( size_t block = 1; block < ( vector1.size() + dequeSize - 1 ) / dequeSize; block++ )
+         if( map2[ block ] != map2[ 0 ] + block * dequeSize )
+            numErrors++;
+
+      size_t n = 0;
+      typename deque< T >::iterator it3 = deque3.begin();
+      for( typename deque< T >::iterator it2 = deque2.begin(); it2 != deque2.end(); ++it2, ++it3, ++n )
+         if( it3 == deque3.end() || *it2 != vector1[ n ] || *it3 != vector1[ n ] )
+            numErrors++;
+      if( n != vector1.size() || it3 != deque3.end() )
+         numErrors++;
+   }
+
+   deque< T > deque2{ static_cast< T >( 1 ), static_cast< T >( 2 ), static_cast< T >( 3 ) };
+   T sum = 0;
+   for( typename deque< T >::iterator it = deque2.begin(); it != deque2.end(); ++it )
+      sum += *it;
+   if( sum != static_cast< T >( 6 ) )
+      numErrors++;
+
+   cout << "There are " << numErrors << " errors\n\n";
+}
+
 // return number of elements per block (a power of 2)
 template< typename T >
 size_t compDequeSize()
@@ -3,7 +3,49 @@ using std::cout;
 using std::endl;
 
 #include <deque>
+#include <memory>
+#include <iterator>
+#include <memory_resource>
+#include <sstream>
+#include <vector>
 #include "Student ID - deque - insert.h"
+#include "Huge Page Resource.h"
+
+// an element owning its value on the heap, whose copy throws once
+// countdown copies have been made; countdown == 0 never throws
+template< typename T >
+struct CopyThrows
+{
+   static inline size_t countdown = 0;
+
+   explicit CopyThrows( T val )
+      : value( new T( val ) )
+   {
+   }
+
+   CopyThrows( const CopyThrows &right )
+      : value( nullptr )
+   {
+      if( countdown > 0 && --countdown == 0 )
+         throw 0;
+      value = new T( *right.value );
+   }
+
+   CopyThrows( CopyThrows &&right ) noexcept
+      : value( right.value )
+   {
+      right.value = nullptr;
+   }
+
+   CopyThrows& operator=( const CopyThrows & ) = delete;
+
+   ~CopyThrows()
+   {
+      delete value;
+   }
+
+   T *value;
+};
 
 template< typename T >
 size_t compDequeSize();
@@ -41,9 +83,57 @@ void testInsert9();
 template< typename T >
 void testInsert10();
 
+template< typename T >
+void testInsert11();
+
+template< typename T >
+void testInsert12();
+
+template< typename T >
+void testInsert13();
+
+template< typename T >
+void testInsert14();
+
+template< typename T >
+void testInsert15();
+
+template< typename T >
+void testInsert16();
+
+template< typename T >
+void testInsert17();
+
+template< typename T >
+void testInsert18();
+
+template< typename T >
+void testInsert19();
+
+template< typename T >
+void testInsert20();
+
+template< typename T, size_t Count >
+void testInsert21();
+
+template< typename T >
+void testInsert22();
+
+template< typename T >
+void testInsert23();
+
 template< typename T >
 bool equal( std::deque< T > &data1, deque< T > &data2 );
 
+template< typename T, typename Deque >
+bool sameElements( std::deque< T > &data1, Deque &data2 );
+
+template< typename T >
+T** allocMap( size_t mapSize );
+
+template< typename T >
+T* allocBlock( size_t dequeSize );
+
 int main()
 {
    testInsert< char >();
@@ -76,6 +166,20 @@ void testInsert()
    testInsert8< T >();
    testInsert9< T >();
    testInsert10< T >();
+   testInsert11< T >();
+   testInsert12< T >();
+   testInsert13< T >();
+   testInsert14< T >();
+   testInsert15< T >();
+   testInsert16< T >();
+   testInsert17< T >();
+   testInsert18< T >();
+   testInsert19< T >();
+   testInsert20< T >();
+   testInsert21< T, 1 >();
+   testInsert21< T, 4 >();
+   testInsert22< T >();
+   testInsert23< T >();
 /*
 */
 }
@@ -118,8 +222,8 @@ void testInsert1()
 
                *mapSize1 = mapSize;
                *mapSize2 = mapSize;
-               *map1 = new T * [ mapSize ]();
-               *map2 = new T * [ mapSize ]();
+               *map1 = allocMap< T >( mapSize );
+               *map2 = allocMap< T >( mapSize );
                *myOff1 = myOff;
                *myOff2 = myOff;
                *mySize1 = mySize;
@@ -127,8 +231,8 @@ void testInsert1()
 
                for( size_t block = myOff / dequeSize; block <= ( myOff + mySize - 1 ) / dequeSize; block++ )
                {
-                  ( *map1 )[ block % mapSize ] = new T[ dequeSize ];
-                  ( *map2 )[ block % mapSize ] = new T[ dequeSize ];
+                  ( *map1 )[ block % mapSize ] = allocBlock< T >( dequeSize );
+                  ( *map2 )[ block % mapSize ] = allocBlock< T >( dequeSize );
                }
 
                for( size_t i = myOff; i < myOff + mySize; i++ )
@@ -185,8 +289,8 @@ void testInsert2()
 
             *mapSize1 = mapSize;
             *mapSize2 = mapSize;
-            *map1 = new T*[ mapSize ]();
-            *map2 = new T*[ mapSize ]();
+            *map1 = allocMap< T >( mapSize );
+            *map2 = allocMap< T >( mapSize );
             *myOff1 = myOff;
             *myOff2 = myOff;
             *mySize1 = mySize;
@@ -194,8 +298,8 @@ void testInsert2()
 
             for( size_t block = myOff / dequeSize; block <= ( myOff + mySize - 1 ) / dequeSize; block++ )
             {
-               ( *map1 )[ block % mapSize ] = new T[ dequeSize ];
-               ( *map2 )[ block % mapSize ] = new T[ dequeSize ];
+               ( *map1 )[ block % mapSize ] = allocBlock< T >( dequeSize );
+               ( *map2 )[ block % mapSize ] = allocBlock< T >( dequeSize );
             }
 
             for( size_t i = myOff; i < myOff + mySize; i++ )
@@ -248,8 +352,8 @@ void testInsert3()
 
                *mapSize1 = mapSize;
                *mapSize2 = mapSize;
-               *map1 = new T * [ mapSize ]();
-               *map2 = new T * [ mapSize ]();
+               *map1 = allocMap< T >( mapSize );
+               *map2 = allocMap< T >( mapSize );
                *myOff1 = myOff;
                *myOff2 = myOff;
                *mySize1 = mySize;
@@ -257,8 +361,8 @@ void testInsert3()
 
                for( size_t block = myOff / dequeSize; block <= ( myOff + mySize - 1 ) / dequeSize; block++ )
                {
-                  ( *map1 )[ block % mapSize ] = new T[ dequeSize ];
-                  ( *map2 )[ block % mapSize ] = new T[ dequeSize ];
+                  ( *map1 )[ block % mapSize ] = allocBlock< T >( dequeSize );
+                  ( *map2 )[ block % mapSize ] = allocBlock< T >( dequeSize );
                }
 
                for( size_t i = myOff; i < myOff + mySize; i++ )
@@ -317,8 +421,8 @@ void testInsert4()
 
                *mapSize1 = mapSize;
                *mapSize2 = mapSize;
-               *map1 = new T * [ mapSize ]();
-               *map2 = new T * [ mapSize ]();
+               *map1 = allocMap< T >( mapSize );
+               *map2 = allocMap< T >( mapSize );
                *myOff1 = myOff;
                *myOff2 = myOff;
                *mySize1 = mySize;
@@ -326,8 +430,8 @@ void testInsert4()
 
                for( size_t block = myOff / dequeSize; block <= ( myOff + mySize - 1 ) / dequeSize; block++ )
                {
-                  ( *map1 )[ block % mapSize ] = new T[ dequeSize ];
-                  ( *map2 )[ block % mapSize ] = new T[ dequeSize ];
+                  ( *map1 )[ block % mapSize ] = allocBlock< T >( dequeSize );
+                  ( *map2 )[ block % mapSize ] = allocBlock< T >( dequeSize );
                }
 
                for( size_t i = myOff; i < myOff + mySize; i++ )
@@ -400,8 +504,8 @@ void testInsert5()
 
                *mapSize1 = mapSize;
                *mapSize2 = mapSize;
-               *map1 = new T * [ mapSize ]();
-               *map2 = new T * [ mapSize ]();
+               *map1 = allocMap< T >( mapSize );
+               *map2 = allocMap< T >( mapSize );
                *myOff1 = myOff;
                *myOff2 = myOff;
                *mySize1 = mySize;
@@ -409,8 +513,8 @@ void testInsert5()
 
                for( size_t block = myOff / dequeSize; block <= ( myOff + mySize - 1 ) / dequeSize; block++ )
                {
-                  ( *map1 )[ block % mapSize ] = new T[ dequeSize ];
-                  ( *map2 )[ block % mapSize ] = new T[ dequeSize ];
+                  ( *map1 )[ block % mapSize ] = allocBlock< T >( dequeSize );
+                  ( *map2 )[ block % mapSize ] = allocBlock< T >( dequeSize );
                }
 
                for( size_t i = myOff; i < myOff + mySize; i++ )
@@ -487,8 +591,8 @@ void testInsert6()
 
             *mapSize1 = mapSize;
             *mapSize2 = mapSize;
-            *map1 = new T*[ mapSize ]();
-            *map2 = new T*[ mapSize ]();
+            *map1 = allocMap< T >( mapSize );
+            *map2 = allocMap< T >( mapSize );
             *myOff1 = myOff;
             *myOff2 = myOff;
             *mySize1 = mySize;
@@ -496,8 +600,8 @@ void testInsert6()
 
             for( size_t block = myOff / dequeSize; block <= ( myOff + mySize - 1 ) / dequeSize; block++ )
             {
-               ( *map1 )[ block % mapSize ] = new T[ dequeSize ];
-               ( *map2 )[ block % mapSize ] = new T[ dequeSize ];
+               ( *map1 )[ block % mapSize ] = allocBlock< T >( dequeSize );
+               ( *map2 )[ block % mapSize ] = allocBlock< T >( dequeSize );
             }
 
             for( size_t i = myOff; i < myOff + mySize; i++ )
@@ -549,8 +653,8 @@ void testInsert7()
 
             *mapSize1 = mapSize;
             *mapSize2 = mapSize;
-            *map1 = new T*[ mapSize ]();
-            *map2 = new T*[ mapSize ]();
+            *map1 = allocMap< T >( mapSize );
+            *map2 = allocMap< T >( mapSize );
             *myOff1 = myOff;
             *myOff2 = myOff;
             *mySize1 = mySize;
@@ -558,8 +662,8 @@ void testInsert7()
 
             for( size_t block = myOff / dequeSize; block <= ( myOff + mySize - 1 ) / dequeSize; block++ )
             {
-               ( *map1 )[ block % mapSize ] = new T[ dequeSize ];
-               ( *map2 )[ block % mapSize ] = new T[ dequeSize ];
+               ( *map1 )[ block % mapSize ] = allocBlock< T >( dequeSize );
+               ( *map2 )[ block % mapSize ] = allocBlock< T >( dequeSize );
             }
 
             for( size_t i = myOff; i < myOff + mySize; i++ )
@@ -630,8 +734,8 @@ void testInsert8()
 
             *mapSize1 = mapSize;
             *mapSize2 = mapSize;
-            *map1 = new T*[ mapSize ]();
-            *map2 = new T*[ mapSize ]();
+            *map1 = allocMap< T >( mapSize );
+            *map2 = allocMap< T >( mapSize );
             *myOff1 = myOff;
             *myOff2 = myOff;
             *mySize1 = mySize;
@@ -639,8 +743,8 @@ void testInsert8()
 
             for( size_t block = myOff / dequeSize; block <= ( myOff + mySize - 1 ) / dequeSize; block++ )
             {
-               ( *map1 )[ block % mapSize ] = new T[ dequeSize ];
-               ( *map2 )[ block % mapSize ] = new T[ dequeSize ];
+               ( *map1 )[ block % mapSize ] = allocBlock< T >( dequeSize );
+               ( *map2 )[ block % mapSize ] = allocBlock< T >( dequeSize );
             }
 
             for( size_t i = myOff; i < myOff + mySize; i++ )
@@ -692,8 +796,8 @@ void testInsert9()
 
             *mapSize1 = mapSize;
             *mapSize2 = mapSize;
-            *map1 = new T*[ mapSize ]();
-            *map2 = new T*[ mapSize ]();
+            *map1 = allocMap< T >( mapSize );
+            *map2 = allocMap< T >( mapSize );
             *myOff1 = myOff;
             *myOff2 = myOff;
             *mySize1 = mySize;
@@ -701,8 +805,8 @@ void testInsert9()
 
             for( size_t block = myOff / dequeSize; block <= ( myOff + mySize - 1 ) / dequeSize; block++ )
             {
-               ( *map1 )[ block % mapSize ] = new T[ dequeSize ];
-               ( *map2 )[ block % mapSize ] = new T[ dequeSize ];
+               ( *map1 )[ block % mapSize ] = allocBlock< T >( dequeSize );
+               ( *map2 )[ block % mapSize ] = allocBlock< T >( dequeSize );
             }
 
             for( size_t i = myOff; i < myOff + mySize; i++ )
@@ -795,8 +899,8 @@ void testInsert10()
 
       *mapSize1 = mapSize;
       *mapSize2 = mapSize;
-      *map1 = new T*[ mapSize ]();
-      *map2 = new T*[ mapSize ]();
+      *map1 = allocMap< T >( mapSize );
+      *map2 = allocMap< T >( mapSize );
       *myOff1 = 0;
       *myOff2 = 0;
       *mySize1 = 0;
@@ -813,6 +917,786 @@ void testInsert10()
    cout << "There are " << numErrors << " errors\n\n";
 }
 
+// bulk insert( where, count, val ) and insert( where, first, last );
+// only the element sequence is compared, as the block layout is free
+template< typename T >
+void testInsert11()
+{
+   size_t numErrors = 0;
+
+   for( int i = 0; i < 200; i++ )
+   {
+      std::deque< T > deque1;
+      deque< T > deque2;
+
+      for( int j = 0; j < 10; j++ )
+      {
+         size_t position = rand() % ( deque1.size() + 1 );
+         size_t count = rand() % ( j % 2 == 0 ? 8 : 300 );
+         if( rand() % 2 == 0 )
+         {
+            T value = 1 + rand() % 99;
+            deque1.insert( deque1.begin() + position, count, value );
+            deque2.insert( deque2.begin() + position, count, value );
+         }
+         else
+         {
+            T *values = new T[ count + 1 ];
+            for( size_t k = 0; k < count; k++ )
+               values[ k ] = static_cast< T >( rand() );
+            deque1.insert( deque1.begin() + position, values, values + count );
+            deque2.insert( deque2.begin() + position, values, values + count );
+            delete[] values;
+         }
+
+         if( !sameElements( deque1, deque2 ) )
+            numErrors++;
+      }
+   }
+
+   cout << "There are " << numErrors << " errors\n\n";
+}
+
+// insert( where, value_type && ) and emplace( where, args ),
+// including values taken from the deque itself
+template< typename T >
+void testInsert12()
+{
+   size_t numErrors = 0;
+
+   for( int i = 0; i < 200; i++ )
+   {
+      std::deque< T > deque1;
+      deque< T > deque2;
+
+      for( int j = 0; j < 100; j++ )
+      {
+         size_t position = rand() % ( deque1.size() + 1 );
+         if( j % 3 == 0 )
+         {
+            T value = static_cast< T >( rand() );
+            deque1.insert( deque1.begin() + position, value );
+            deque2.insert( deque2.begin() + position, std::move( value ) );
+         }
+         else if( j % 3 == 1 )
+         {
+            int value = rand();
+            deque1.emplace( deque1.begin() + position, static_cast< T >( value ) );
+            deque2.emplace( deque2.begin() + position, static_cast< T >( value ) );
+         }
+         else
+         {
+            size_t source = rand() % deque1.size();
+            deque1.emplace( deque1.begin() + position, deque1[ source ] );
+            deque2.emplace( deque2.begin() + position, *( deque2.begin() + source ) );
+         }
+      }
+
+      if( !sameElements( deque1, deque2 ) )
+         numErrors++;
+   }
+
+   cout << "There are " << numErrors << " errors\n\n";
+}
+
+// push/pop at both ends and clear_keep_capacity, as a work queue
+// that keeps draining and refilling
+template< typename T >
+void testInsert13()
+{
+   size_t numErrors = 0;
+
+   std::deque< T > deque1;
+   deque< T > deque2;
+   for( int i = 0; i < 200; i++ )
+   {
+      for( int j = 0; j < 1000; j++ )
+      {
+         T value = static_cast< T >( rand() );
+         switch( rand() % ( i % 2 == 0 ? 5 : 7 ) )
+         {
+         case 0:
+         case 1:
+            deque1.push_back( value );
+            deque2.push_back( value );
+            break;
+         case 2:
+            deque1.push_front( value );
+            deque2.emplace_front( value );
+            break;
+         default:
+            if( deque1.empty() )
+               break;
+            if( rand() % 2 == 0 )
+            {
+               deque1.pop_front();
+               deque2.pop_front();
+            }
+            else
+            {
+               deque1.pop_back();
+               deque2.pop_back();
+            }
+         }
+
+         if( !deque1.empty() && ( deque1.front() != deque2.front() || deque1.back() != deque2.back() ) )
+            numErrors++;
+      }
+
+      if( !sameElements( deque1, deque2 ) )
+         numErrors++;
+
+      if( i % 10 == 9 )
+      {
+         deque1.clear();
+         deque2.clear_keep_capacity();
+      }
+   }
+
+   cout << "There are " << numErrors << " errors\n\n";
+}
+
+// memory resource that counts its allocations and the bytes it has handed out
+// and not yet taken back
+class CountingResource : public std::pmr::memory_resource
+{
+public:
+   size_t live = 0;
+   size_t allocations = 0;
+
+private:
+   void *do_allocate( size_t bytes, size_t alignment ) override
+   {
+      live += bytes;
+      allocations++;
+      return std::pmr::new_delete_resource()->allocate( bytes, alignment );
+   }
+
+   void do_deallocate( void *p, size_t bytes, size_t alignment ) override
+   {
+      live -= bytes;
+      std::pmr::new_delete_resource()->deallocate( p, bytes, alignment );
+   }
+
+   bool do_is_equal( const std::pmr::memory_resource &other ) const noexcept override
+   {
+      return this == &other;
+   }
+};
+
+// push and pop through a polymorphic allocator; the map, the blocks and the spare
+// blocks must all come from, and all go back to, the deque's memory resource
+template< typename T >
+void testInsert14()
+{
+   size_t numErrors = 0;
+
+   CountingResource resource;
+   {
+      std::deque< T > deque1;
+      deque< T, DequeDefaultBlock, std::pmr::polymorphic_allocator< T > > deque2( &resource );
+      if( deque2.get_allocator().resource() != &resource )
+         numErrors++;
+
+      for( int i = 0; i < 20000; i++ )
+      {
+         T value = static_cast< T >( rand() );
+         switch( rand() % 4 )
+         {
+         case 0:
+            deque1.push_back( value );
+            deque2.push_back( value );
+            break;
+         case 1:
+            deque1.push_front( value );
+            deque2.push_front( value );
+            break;
+         default:
+            if( deque1.empty() )
+               break;
+            deque1.pop_front();
+            deque2.pop_front();
+         }
+
+         if( deque1.size() != deque2.size() ||
+            ( !deque1.empty() && ( deque1.front() != deque2.front() || deque1.back() != deque2.back() ) ) )
+            numErrors++;
+      }
+
+      if( deque2.size() > 0 && resource.live == 0 )
+         numErrors++;
+   }
+
+   if( resource.live != 0 )
+      numErrors++;
+
+   cout << "There are " << numErrors << " errors\n\n";
+}
+
+// drain bursts down to a short queue with auto trim on, then shrink_to_fit;
+// the elements must survive and the memory must go back to the resource
+template< typename T >
+void testInsert15()
+{
+   size_t dequeSize = compDequeSize< T >(); // elements per block (a power of 2)
+   size_t numErrors = 0;
+
+   CountingResource resource;
+   {
+      std::deque< T > deque1;
+      deque< T, DequeDefaultBlock, std::pmr::polymorphic_allocator< T > > deque2( &resource );
+      size_t *mapSize2 = reinterpret_cast< size_t * >( &deque2 ) + 1;
+      deque2.set_auto_trim( 25 );
+
+      for( int burst = 0; burst < 4; burst++ )
+      {
+         for( int i = 0; i < 50000; i++ )
+         {
+            T value = static_cast< T >( rand() );
+            if( rand() % 2 == 0 )
+            {
+               deque1.push_back( value );
+               deque2.push_back( value );
+            }
+            else
+            {
+               deque1.push_front( value );
+               deque2.push_front( value );
+            }
+         }
+         size_t peak = resource.live;
+
+         while( deque1.size() > 300 )
+            if( rand() % 2 == 0 )
+            {
+               deque1.pop_front();
+               deque2.pop_front();
+            }
+            else
+            {
+               deque1.pop_back();
+               deque2.pop_back();
+            }
+
+         if( !sameElements( deque1, deque2 ) || resource.live * 4 > peak ||
+             *mapSize2 * dequeSize * 25 > 100 * 300 + 100 * 2 * dequeSize * 8 )
+            numErrors++;
+
+         deque2.shrink_to_fit();
+         size_t fit = 8;
+         while( fit <= ( deque2.size() + dequeSize ) / dequeSize )
+            fit *= 2;
+         if( !sameElements( deque1, deque2 ) || *mapSize2 != fit )
+            numErrors++;
+      }
+
+      while( !deque1.empty() )
+      {
+         deque1.pop_back();
+         deque2.pop_back();
+      }
+      deque2.shrink_to_fit();
+      if( *mapSize2 != 0 || resource.live != 0 )
+         numErrors++;
+   }
+
+   cout << "There are " << numErrors << " errors\n\n";
+}
+
+// reserve at either end, then push or insert that many elements there;
+// none of them may allocate
+template< typename T >
+void testInsert16()
+{
+   size_t numErrors = 0;
+
+   CountingResource resource;
+   std::deque< T > deque1;
+   deque< T, DequeDefaultBlock, std::pmr::polymorphic_allocator< T > > deque2( &resource );
+   for( int i = 0; i < 300; i++ )
+   {
+      size_t count = rand() % 2000;
+      bool front = rand() % 2 == 0;
+      if( front )
+         deque2.reserve_front( count );
+      else if( rand() % 2 == 0 )
+         deque2.reserve_back( count );
+      else
+         deque2.reserve( deque2.size() + count );
+
+      if( ( front ? deque2.capacity_front() : deque2.capacity_back() ) < count ||
+          deque2.capacity() < deque2.size() + count )
+         numErrors++;
+
+      size_t allocations = resource.allocations;
+      for( size_t j = 0; j < count; j++ )
+      {
+         T value = static_cast< T >( rand() );
+         if( front )
+         {
+            deque1.push_front( value );
+            if( j % 3 == 0 )
+               deque2.insert( deque2.begin(), value );
+            else
+               deque2.push_front( value );
+         }
+         else
+         {
+            deque1.push_back( value );
+            if( j % 3 == 0 )
+               deque2.insert( deque2.end(), value );
+            else
+               deque2.emplace_back( value );
+         }
+      }
+      if( resource.allocations != allocations )
+         numErrors++;
+
+      for( size_t j = rand() % ( deque1.size() + 1 ); j > 0; j-- )
+         if( rand() % 2 == 0 )
+         {
+            deque1.pop_front();
+            deque2.pop_front();
+         }
+         else
+         {
+            deque1.pop_back();
+            deque2.pop_back();
+         }
+
+      if( !sameElements( deque1, deque2 ) )
+         numErrors++;
+   }
+
+   cout << "There are " << numErrors << " errors\n\n";
+}
+
+// check memory_stats() against the map itself while the deque grows and drains,
+// and its byte count against what the memory resource handed out
+template< typename T >
+void testInsert17()
+{
+   size_t dequeSize = compDequeSize< T >(); // elements per block (a power of 2)
+   size_t numErrors = 0;
+
+   CountingResource resource;
+   deque< T, DequeDefaultBlock, std::pmr::polymorphic_allocator< T > > deque2( &resource );
+   T ***map2 = reinterpret_cast< T *** > ( &deque2 );
+   size_t *mapSize2 = reinterpret_cast< size_t * >( &deque2 ) + 1;
+   size_t *myOff2 = reinterpret_cast< size_t * >( &deque2 ) + 2;
+   size_t *mySize2 = reinterpret_cast< size_t * >( &deque2 ) + 3;
+
+   size_t growths = 0;
+   size_t lastMapSize = 0;
+   for( int i = 0; i < 20000; i++ )
+   {
+      if( rand() % 3 != 0 )
+         if( rand() % 2 == 0 )
+            deque2.push_back( static_cast< T >( i ) );
+         else
+            deque2.push_front( static_cast< T >( i ) );
+      else if( !deque2.empty() )
+         deque2.pop_front();
+
+      if( *mapSize2 > lastMapSize )
+         growths++;
+      lastMapSize = *mapSize2;
+
+      DequeMemoryStats stats = deque2.memory_stats();
+      size_t blocks = 0;
+      for( size_t j = 0; j < *mapSize2; j++ )
+         if( ( *map2 )[ j ] != nullptr )
+            blocks++;
+
+      if( stats.mapSlots != *mapSize2 || stats.blocks != blocks ||
+          stats.nullSlots != *mapSize2 - blocks || stats.totalBytes != resource.live ||
+          stats.growthEvents != growths ||
+          stats.liveBlocks * dequeSize != stats.frontSlack + *mySize2 + stats.backSlack ||
+          ( *mySize2 > 0 && stats.frontSlack != *myOff2 % dequeSize ) ||
+          stats.occupancy * ( blocks + stats.spareBlocks ) * dequeSize + 0.5 < *mySize2 )
+         numErrors++;
+   }
+
+   cout << "There are " << numErrors << " errors\n\n";
+}
+
+// push, insert and pop with blocks and maps carved from huge-page regions and
+// recycled through the resource's free lists; release() unmaps everything
+template< typename T >
+void testInsert18()
+{
+   size_t numErrors = 0;
+
+   HugePageResource resource( HugePageResource::hugePageSize );
+   for( int round = 0; round < 3; round++ )
+   {
+      std::deque< T > deque1;
+      deque< T, DequeDefaultBlock, std::pmr::polymorphic_allocator< T > > deque2( &resource );
+      for( int i = 0; i < 300000; i++ )
+      {
+         T value = static_cast< T >( rand() );
+         switch( rand() % 8 )
+         {
+         case 0:
+         case 1:
+         case 2:
+            deque1.push_back( value );
+            deque2.push_back( value );
+            break;
+         case 3:
+         case 4:
+            deque1.push_front( value );
+            deque2.push_front( value );
+            break;
+         case 5:
+         {
+            size_t off = rand() % ( deque1.size() + 1 );
+            deque1.insert( deque1.begin() + off, value );
+            deque2.insert( deque2.begin() + off, value );
+            break;
+         }
+         default:
+            if( !deque1.empty() )
+            {
+               deque1.pop_front();
+               deque2.pop_front();
+            }
+         }
+         if( i % 1000 == 0 && deque1.size() > 3000 )
+            while( deque1.size() > 100 )
+            {
+               deque1.pop_back();
+               deque2.pop_back();
+            }
+      }
+
+      if( !sameElements( deque1, deque2 ) || resource.mapped_bytes() == 0 )
+         numErrors++;
+   }
+
+   resource.release();
+   if( resource.mapped_bytes() != 0 )
+      numErrors++;
+
+   cout << "There are " << numErrors << " errors\n\n";
+}
+
+// move deques around: into a growing std::vector, by move assignment, and
+// between memory resources that do not compare equal
+template< typename T >
+void testInsert19()
+{
+   static_assert( std::is_nothrow_move_constructible< deque< T > >::value &&
+                  std::is_nothrow_move_assignable< deque< T > >::value,
+                  "deque must move without throwing" );
+
+   size_t numErrors = 0;
+
+   std::vector< std::deque< T > > vector1;
+   std::vector< deque< T > > vector2;
+   for( int i = 0; i < 100; i++ )
+   {
+      std::deque< T > deque1;
+      deque< T > deque2;
+      for( int j = rand() % 500; j > 0; j-- )
+      {
+         T value = static_cast< T >( rand() );
+         deque1.push_back( value );
+         deque2.push_back( value );
+      }
+      vector1.push_back( std::move( deque1 ) );
+      vector2.push_back( std::move( deque2 ) );
+      if( !deque2.empty() || deque2.begin() != deque2.end() )
+         numErrors++;
+   }
+
+   for( size_t i = 0; i < vector1.size(); i++ )
+   {
+      size_t j = rand() % vector1.size();
+      if( j == i ) // std::deque leaves a self-moved deque unspecified
+         continue;
+      vector1[ i ] = std::move( vector1[ j ] );
+      vector2[ i ] = std::move( vector2[ j ] );
+      for( size_t k = 0; k < vector1.size(); k++ )
+         if( !sameElements( vector1[ k ], vector2[ k ] ) )
+            numErrors++;
+      vector2[ j ].push_back( static_cast< T >( i ) ); // a moved-from deque is usable
+      vector1[ j ].push_back( static_cast< T >( i ) );
+   }
+
+   CountingResource resource1;
+   CountingResource resource2;
+   {
+      std::deque< T > deque1;
+      deque< T, DequeDefaultBlock, std::pmr::polymorphic_allocator< T > > deque2( &resource1 );
+      deque< T, DequeDefaultBlock, std::pmr::polymorphic_allocator< T > > deque3( &resource2 );
+      for( int j = 0; j < 1000; j++ )
+      {
+         deque1.push_front( static_cast< T >( j ) );
+         deque2.push_front( static_cast< T >( j ) );
+      }
+
+      deque3 = std::move( deque2 ); // unequal resources: the elements move, not the blocks
+      if( !sameElements( deque1, deque3 ) || resource1.live != 0 ||
+          deque3.get_allocator().resource() != &resource2 )
+         numErrors++;
+
+      deque< T, DequeDefaultBlock, std::pmr::polymorphic_allocator< T > > deque4( std::move( deque3 ) );
+      if( !sameElements( deque1, deque4 ) || deque4.get_allocator().resource() != &resource2 )
+         numErrors++;
+   }
+   if( resource2.live != 0 )
+      numErrors++;
+
+   cout << "There are " << numErrors << " errors\n\n";
+}
+
+// construct from a forward range, which sizes the map exactly once, from a
+// stream read through input iterators, and from an initializer list
+template< typename T >
+void testInsert20()
+{
+   size_t numErrors = 0;
+
+   for( int i = 0; i < 200; i++ )
+   {
+      std::vector< T > vector1;
+      std::ostringstream stream;
+      for( int j = rand() % 1000; j > 0; j-- )
+      {
+         T value = static_cast< T >( rand() );
+         vector1.push_back( value );
+         stream << static_cast< long long >( value ) << ' ';
+      }
+
+      std::deque< T > deque1( vector1.begin(), vector1.end() );
+      deque< T > deque2( vector1.begin(), vector1.end() );
+      if( !sameElements( deque1, deque2 ) || deque2.memory_stats().growthEvents != ( vector1.empty() ? 0u : 1u ) )
+         numErrors++;
+
+      std::istringstream input( stream.str() );
+      deque< T > deque3( std::istream_iterator< long long >( input ), ( std::istream_iterator< long long >() ) );
+      if( !sameElements( deque1, deque3 ) )
+         numErrors++;
+
+      T value = static_cast< T >( rand() ); // each grows on from where construction left it
+      deque1.push_back( value );
+      deque2.push_back( value );
+      deque3.push_back( value );
+      deque1.push_front( value );
+      deque2.push_front( value );
+      deque3.push_front( value );
+      if( !sameElements( deque1, deque2 ) || !sameElements( deque1, deque3 ) )
+         numErrors++;
+   }
+
+   std::deque< T > deque1{ static_cast< T >( 1 ), static_cast< T >( 2 ), static_cast< T >( 3 ) };
+   deque< T > deque2{ static_cast< T >( 1 ), static_cast< T >( 2 ), static_cast< T >( 3 ) };
+   if( !sameElements( deque1, deque2 ) )
+      numErrors++;
+
+   cout << "There are " << numErrors << " errors\n\n";
+}
+
+// with Count elements per block, insert, push and pop at random positions and
+// read every element back by iterator arithmetic; each step crosses block
+// boundaries, and a segment never spans more than one block
+template< typename T, size_t Count >
+void testInsert21()
+{
+   size_t numErrors = 0;
+
+   for( int i = 0; i < 300; i++ )
+   {
+      std::deque< T > deque1;
+      deque< T, DequeBlockElements< Count > > deque2;
+      for( int j = 0; j < 60; j++ )
+      {
+         T value = static_cast< T >( rand() );
+         size_t pos = rand() % ( deque1.size() + 1 );
+         switch( rand() % 5 )
+         {
+         case 0:
+            deque1.push_front( value );
+            deque2.push_front( value );
+            break;
+         case 1:
+            deque1.push_back( value );
+            deque2.push_back( value );
+            break;
+         case 2:
+            if( !deque1.empty() )
+            {
+               deque1.pop_front();
+               deque2.pop_front();
+               break;
+            }
+            [[fallthrough]];
+         default:
+         {
+            size_t count = rand() % ( 3 * Count + 1 );
+            deque1.insert( deque1.begin() + pos, count, value );
+            typename deque< T, DequeBlockElements< Count > >::iterator it = deque2.insert( deque2.begin() + pos, count, value );
+            if( it != deque2.begin() + pos )
+               numErrors++;
+         }
+         }
+
+         if( !sameElements( deque1, deque2 ) )
+            numErrors++;
+
+         for( size_t k = 0; k < deque1.size(); k++ )
+            if( deque2.begin()[ k ] != deque1[ k ] || *( deque2.end() - ( deque1.size() - k ) ) != deque1[ k ] )
+               numErrors++;
+
+         size_t covered = 0;
+         deque2.for_each_segment( [ & ]( T *p, size_t count )
+         {
+            if( count > Count || p != &deque2.begin()[ covered ] )
+               numErrors++;
+            covered += count;
+         } );
+         if( covered != deque1.size() )
+            numErrors++;
+      }
+   }
+
+   cout << "There are " << numErrors << " errors\n\n";
+}
+
+// for_each_segment, through a mutable and a const deque, must visit runs that
+// cover exactly [ begin, end ) in order, each run contiguous and within one
+// block, also once the sequence wraps around the end of the map
+template< typename T >
+void testInsert22()
+{
+   size_t dequeSize = compDequeSize< T >(); // elements per block (a power of 2)
+   size_t numErrors = 0;
+   size_t numWrapped = 0;
+
+   for( int i = 0; i < 500; i++ )
+   {
+      deque< T > deque2;
+      size_t *mapSize2 = reinterpret_cast< size_t * >( &deque2 ) + 1;
+      size_t *myOff2 = reinterpret_cast< size_t * >( &deque2 ) + 2;
+      for( int j = rand() % ( 10 * dequeSize ); j > 0; j-- )
+         if( rand() % 3 == 0 )
+            deque2.push_back( static_cast< T >( rand() ) );
+         else
+            deque2.push_front( static_cast< T >( rand() ) );
+
+      if( *myOff2 + deque2.size() > *mapSize2 * dequeSize )
+         numWrapped++;
+
+      for( int pass = 0; pass < 2; pass++ )
+      {
+         size_t covered = 0;
+         auto visit = [ & ]( const T *p, size_t count )
+         {
+            if( count == 0 || count > dequeSize )
+               numErrors++;
+            for( size_t k = 0; k < count && covered + k < deque2.size(); k++ )
+               if( p + k != &*( deque2.begin() + ( covered + k ) ) )
+                  numErrors++;
+            if( ( *myOff2 + covered ) / dequeSize != ( *myOff2 + covered + count - 1 ) / dequeSize )
+               numErrors++;
+            covered += count;
+         };
+
+         if( pass == 0 )
+            deque2.for_each_segment( visit );
+         else
+         {
+            const deque< T > &constDeque = deque2;
+            constDeque.for_each_segment( visit );
+         }
+         if( covered != deque2.size() )
+            numErrors++;
+      }
+   }
+
+   if( numWrapped == 0 ) // the wrapped layout must have been covered
+      numErrors++;
+
+   cout << "There are " << numErrors << " errors\n\n";
+}
+
+// insert copies of a value and a forward range whose element copy throws
+// partway; the deque must keep exactly its old elements, in order
+template< typename T >
+void testInsert23()
+{
+   size_t numErrors = 0;
+
+   for( int i = 0; i < 1000; i++ )
+   {
+      std::deque< T > deque1;
+      deque< CopyThrows< T > > deque2;
+      for( int j = rand() % 100; j > 0; j-- )
+      {
+         T value = static_cast< T >( rand() );
+         if( rand() % 2 == 0 )
+         {
+            deque1.push_back( value );
+            deque2.push_back( CopyThrows< T >( value ) );
+         }
+         else
+         {
+            deque1.push_front( value );
+            deque2.push_front( CopyThrows< T >( value ) );
+         }
+      }
+
+      size_t pos = rand() % ( deque1.size() + 1 );
+      size_t count = 1 + rand() % 40;
+      CopyThrows< T > value( static_cast< T >( rand() ) );
+      std::vector< CopyThrows< T > > range;
+      for( size_t j = 0; j < count; j++ )
+         range.push_back( CopyThrows< T >( static_cast< T >( rand() ) ) );
+
+      bool thrown = false;
+      CopyThrows< T >::countdown = 1 + rand() % count;
+      try
+      {
+         if( rand() % 2 == 0 )
+            deque2.insert( deque2.begin() + pos, count, value );
+         else
+            deque2.insert( deque2.begin() + pos, range.begin(), range.end() );
+      }
+      catch( int )
+      {
+         thrown = true;
+      }
+      CopyThrows< T >::countdown = 0;
+
+      if( !thrown || deque2.size() != deque1.size() )
+         numErrors++;
+      else
+      {
+         typename deque< CopyThrows< T > >::iterator it = deque2.begin();
+         for( size_t j = 0; j < deque1.size(); ++j, ++it )
+            if( *it->value != deque1[ j ] )
+               numErrors++;
+      }
+   }
+
+   cout << "There are " << numErrors << " errors\n\n";
+}
+
+template< typename T, typename Deque >
+bool sameElements( std::deque< T > &data1, Deque &data2 )
+{
+   if( data1.size() != data2.size() )
+      return false;
+
+   typename Deque::iterator it2 = data2.begin();
+   for( size_t i = 0; i < data1.size(); ++i, ++it2 )
+      if( data1[ i ] != *it2 )
+         return false;
+
+   return true;
+}
+
 template< typename T >
 bool equal( std::deque< T > &data1, deque< T > &data2 )
 {
@@ -870,4 +1754,22 @@ bool equal( std::deque< T > &data1, deque< T > &data2 )
    }
 
    return true;
+}
+
+// allocate a map of mapSize null block pointers with std::allocator, as the
+// deque does, so the deque may release a map injected into it
+template< typename T >
+T** allocMap( size_t mapSize )
+{
+   T** map = std::allocator< T* >().allocate( mapSize );
+   for( size_t i = 0; i < mapSize; i++ )
+      map[ i ] = nullptr;
+   return map;
+}
+
+// allocate a block of dequeSize elements with std::allocator, as the deque does
+template< typename T >
+T* allocBlock( size_t dequeSize )
+{
+   return std::allocator< T >().allocate( dequeSize );
 }
\ No newline at end of file
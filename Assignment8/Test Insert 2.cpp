@@ -3,6 +3,7 @@ using std::cout;
 using std::endl;
 
 #include <deque>
+#include <memory>
 #include "Student ID - deque - insert2.h"
 
 template< typename T >
@@ -23,6 +24,12 @@ void testInsert3();
 template< typename T >
 bool equal( std::deque< T > &data1, deque< T > &data2 );
 
+template< typename T >
+T** allocMap( size_t mapSize );
+
+template< typename T >
+T* allocBlock( size_t dequeSize );
+
 int main()
 {
 /**/
@@ -78,12 +85,12 @@ void testInsert1()
                size_t *mySize1 = reinterpret_cast< size_t * >( &deque1 ) + 3;
 
                *mapSize1 = mapSize;
-               *map1 = new T * [ mapSize ]();
+               *map1 = allocMap< T >( mapSize );
                *myOff1 = myOff;
                *mySize1 = mySize;
 
                for( size_t block = myOff / dequeSize; block <= ( myOff + mySize - 1 ) / dequeSize; block++ )
-                  ( *map1 )[ block % mapSize ] = new T[ dequeSize ];
+                  ( *map1 )[ block % mapSize ] = allocBlock< T >( dequeSize );
 
                for( size_t i = myOff; i < myOff + mySize; i++ )
                {
@@ -179,7 +186,7 @@ void testInsert3()
       size_t *mySize1 = reinterpret_cast< size_t * >( &deque1 ) + 3;
 
       *mapSize1 = mapSize;
-      *map1 = new T * [ mapSize ]();
+      *map1 = allocMap< T >( mapSize );
       *myOff1 = 0;
       *mySize1 = 0;
 
@@ -262,4 +269,22 @@ bool equal( std::deque< T > &data1, deque< T > &data2 )
    }
 
    return true;
+}
+
+// allocate a map of mapSize null block pointers with std::allocator, as the
+// deque does, so the deque may release a map injected into it
+template< typename T >
+T** allocMap( size_t mapSize )
+{
+   T** map = std::allocator< T* >().allocate( mapSize );
+   for( size_t i = 0; i < mapSize; i++ )
+      map[ i ] = nullptr;
+   return map;
+}
+
+// allocate a block of dequeSize elements with std::allocator, as the deque does
+template< typename T >
+T* allocBlock( size_t dequeSize )
+{
+   return std::allocator< T >().allocate( dequeSize );
 }
\ No newline at end of file